@@ -14,6 +14,48 @@
                 "libs/simulations/avalanche-simulation/terrain",    
                 "libs/simulations/avalanche-simulation/resources",    
             ],
+        },
+        {
+            "target_name": "simulationbenchmark",
+            "type": "executable",
+            "sources": [ 
+                "libs/simulations/simulationbenchmark.cpp",
+            ],
+            "include_dirs" : [ 
+                "libs/xlib", 
+                "libs/simulations",    
+                "libs/simulations/avalanche-simulation",    
+                "libs/simulations/avalanche-simulation/particle",    
+                "libs/simulations/avalanche-simulation/terrain",    
+            ],
+        },
+        {
+            "target_name": "simulationbatch",
+            "type": "executable",
+            "sources": [ 
+                "libs/simulations/simulationbatch.cpp",
+            ],
+            "include_dirs" : [ 
+                "libs/xlib", 
+                "libs/simulations",    
+                "libs/simulations/avalanche-simulation",    
+                "libs/simulations/avalanche-simulation/particle",    
+                "libs/simulations/avalanche-simulation/terrain",    
+            ],
+        },
+        {
+            "target_name": "simulationcalibrate",
+            "type": "executable",
+            "sources": [ 
+                "libs/simulations/simulationcalibrate.cpp",
+            ],
+            "include_dirs" : [ 
+                "libs/xlib", 
+                "libs/simulations",    
+                "libs/simulations/avalanche-simulation",    
+                "libs/simulations/avalanche-simulation/particle",    
+                "libs/simulations/avalanche-simulation/terrain",    
+            ],
         }
     ]
 }
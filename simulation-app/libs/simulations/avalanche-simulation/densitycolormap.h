@@ -0,0 +1,73 @@
+/**
+* densitycolormap.h
+* @fileoverview .h file designed to color particles by the density of the grid cell they are in
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef DENSITYCOLORMAP_H
+#define DENSITYCOLORMAP_H
+
+#include <vector>
+#include "xlib.h"
+
+#define DENSITY_COLORS		256			//entries of the lookup table
+#define DENSITY_COLOR_SCALE	0.0001f		//scales a density from MassMovementSimulator::computeDensity()
+#define DENSITY_COLOR_RANGE	6.0f		//scaled density from which on the first color of the gradient is used
+
+//Gradient from dense to sparse particles turned into a lookup table of RGB8 colors
+//
+//Entry 0 holds the first color of the gradient, used for the densest particles, and entry DENSITY_COLORS - 1 the last one,
+//used for lone particles. In between the gradient is walked by the square of the entry, so its first colors span most entries,
+//and the last color is reached a step early so the sparsest particles share it.
+//A frame only has to find the entry of every grid cell once and gather the colors of its particles from the table.
+struct DensityColorMap {
+
+	//Constructor, white for dense particles through red, yellow, green and cyan to blue for sparse ones
+	DensityColorMap() {
+		std::vector<xlib::vec3> gradient;
+		gradient.push_back(xlib::vec3(1.0, 1.0, 1.0));
+		gradient.push_back(xlib::vec3(1.0, 0.0, 0.0));
+		gradient.push_back(xlib::vec3(1.0, 1.0, 0.0));
+		gradient.push_back(xlib::vec3(0.0, 1.0, 0.0));
+		gradient.push_back(xlib::vec3(0.0, 1.0, 1.0));
+		gradient.push_back(xlib::vec3(0.0, 0.0, 1.0));
+		build(gradient);
+	}
+
+	//Method designed to fill the lookup table from a gradient of at least two colors with components in [0, 1]
+	//returns false and keeps the current table if the gradient is too short
+	bool build(const std::vector<xlib::vec3> &gradient) {
+		int last = (int)gradient.size() - 1;
+		if (last < 1) {
+			return false;
+		}
+		for (int entry = 0; entry < DENSITY_COLORS; entry++) {
+			float t = float(entry) / (DENSITY_COLORS - 1);
+			float position = xlib::fclamp(t * t * gradient.size(), 0, last);
+			int i = xlib::clamp((int)position, 0, last - 1);
+			float w = position - i;
+			xlib::vec3 rgb = gradient[i] * (1.0 - w) + gradient[i + 1] * w;
+			table[entry * 3 + 0] = (unsigned char)(xlib::fclamp(rgb.x, 0, 1.0) * 255.0 + 0.5);
+			table[entry * 3 + 1] = (unsigned char)(xlib::fclamp(rgb.y, 0, 1.0) * 255.0 + 0.5);
+			table[entry * 3 + 2] = (unsigned char)(xlib::fclamp(rgb.z, 0, 1.0) * 255.0 + 0.5);
+		}
+		return true;
+	}
+
+	//Method designed to return the entry of a density from MassMovementSimulator::computeDensity()
+	static unsigned char entry(float density) {
+		float t = xlib::fclamp((DENSITY_COLOR_RANGE - DENSITY_COLOR_SCALE * density) / DENSITY_COLOR_RANGE, 0, 1.0);
+		return (unsigned char)(t * (DENSITY_COLORS - 1) + 0.5f);
+	}
+
+	//Method designed to return the r,g,b color of an entry
+	const unsigned char* color(unsigned char entry) const {
+		return &table[entry * 3];
+	}
+
+private:
+	unsigned char table[DENSITY_COLORS * 3];
+};
+
+#endif
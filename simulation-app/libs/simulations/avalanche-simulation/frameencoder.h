@@ -0,0 +1,166 @@
+/**
+* frameencoder.h
+* @fileoverview .h file designed to encode display frames as quantized keyframes and deltas
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef FRAMEENCODER_H
+#define FRAMEENCODER_H
+
+#include <vector>
+#include <cstring>
+#include "xlib.h"
+
+#define FRAME_HEADER_WORDS	10			//uint32/float32 words in front of every encoded frame
+#define FRAME_KEYFRAME_INTERVAL	120	//default number of frames between keyframes
+
+//Encodes the packed x,y,z / r,g,b frame buffers of a simulation into a compact binary frame
+//
+//Positions are quantized to 16 bits per axis against a bounding box, colors stay 8 bits per channel.
+//A keyframe holds every vertex, a delta frame only holds the vertices that differ from the last keyframe the
+//client acknowledged, so a client can decode any delta frame from that one keyframe even if it missed others.
+//
+//Layout (little endian, every section starts on a 4 byte boundary):
+//	uint32 frame			number of this frame
+//	uint32 keyframe			keyframe this frame is relative to, equal to frame for keyframes
+//	uint32 vertexCount		vertices in the decoded frame
+//	uint32 changedCount		vertices stored in this frame (vertexCount for keyframes)
+//	float32 low[3]			bounding box corner
+//	float32 scale[3]		size of one quantization step along each axis
+//	uint32 index[changedCount]			only in delta frames, vertex each entry replaces
+//	uint16 position[changedCount * 3]	padded to 4 bytes
+//	uint8 color[changedCount * 3]
+struct FrameEncoder {
+
+	int keyframeInterval;		//frames after which a new keyframe is sent
+
+	//Constructor
+	FrameEncoder() {
+		keyframeInterval = FRAME_KEYFRAME_INTERVAL;
+		reset();
+	}
+
+	//Method designed to forget every keyframe, the next frame will be a keyframe numbered 0
+	void reset() {
+		frameNumber = 0;
+		acked.valid = false;
+		pending.valid = false;
+	}
+
+	//Method designed to mark a keyframe as received by the client, returns false if it is not the last keyframe sent
+	bool acknowledge(unsigned int frame) {
+		if (!pending.valid || pending.frame != frame) {
+			return false;
+		}
+		std::swap(acked, pending);
+		pending.valid = false;
+		return true;
+	}
+
+	//Method designed to encode vertexCount vertices quantized against the box [low, high] into out
+	void encode(const float *vertices, const unsigned char *colors, int vertexCount, const xlib::vec3 &low, const xlib::vec3 &high, std::vector<unsigned char> &out) {
+		xlib::vec3 scale = high - low;
+		scale.x = scale.x > 0 ? scale.x / 65535.0f : 1.0f;
+		scale.y = scale.y > 0 ? scale.y / 65535.0f : 1.0f;
+		scale.z = scale.z > 0 ? scale.z / 65535.0f : 1.0f;
+		quantize(vertices, vertexCount, low, scale, positions);
+
+		unsigned int frame = frameNumber++;
+		bool keyframe = !acked.valid || acked.vertexCount != vertexCount || acked.low != low || acked.scale != scale;
+		if (!keyframe && frame - acked.frame >= (unsigned int)keyframeSpacing()) {
+			//wait for the keyframe already in flight before sending another one
+			keyframe = !pending.valid || frame - pending.frame >= (unsigned int)keyframeSpacing();
+		}
+
+		changed.clear();
+		if (!keyframe) {
+			for (int v = 0; v < vertexCount; v++) {
+				if (memcmp(&positions[v * 3], &acked.positions[v * 3], 3 * sizeof(unsigned short)) != 0
+					|| memcmp(&colors[v * 3], &acked.colors[v * 3], 3) != 0) {
+					changed.push_back(v);
+				}
+			}
+			//a delta entry takes 13 bytes and a keyframe entry 9, send a keyframe once it is smaller
+			keyframe = (long long)changed.size() * 13 >= (long long)vertexCount * 9;
+		}
+
+		if (keyframe) {
+			pending.valid = true;
+			pending.frame = frame;
+			pending.vertexCount = vertexCount;
+			pending.low = low;
+			pending.scale = scale;
+			pending.positions = positions;
+			pending.colors.assign(colors, colors + vertexCount * 3);
+			write(out, frame, frame, vertexCount, low, scale, vertexCount, NULL, colors);
+		}
+		else {
+			write(out, frame, acked.frame, vertexCount, low, scale, changed.size(), changed.data(), colors);
+		}
+	}
+
+private:
+	//Quantized copy of a keyframe
+	struct Keyframe {
+		bool valid;
+		unsigned int frame;
+		int vertexCount;
+		xlib::vec3 low;
+		xlib::vec3 scale;
+		std::vector<unsigned short> positions;
+		std::vector<unsigned char> colors;
+	};
+
+	unsigned int frameNumber;				//number of the next frame
+	Keyframe acked;							//last keyframe the client acknowledged, deltas are relative to it
+	Keyframe pending;						//last keyframe sent that has not been acknowledged yet
+	std::vector<unsigned short> positions;	//quantized positions of the frame being encoded
+	std::vector<int> changed;				//vertices of the frame being encoded that differ from the acknowledged keyframe
+
+	//Method designed to return the keyframe interval, at least 1
+	int keyframeSpacing() const {
+		return keyframeInterval > 1 ? keyframeInterval : 1;
+	}
+
+	//Method designed to quantize vertexCount x,y,z positions to 16 bits per axis
+	static void quantize(const float *vertices, int vertexCount, const xlib::vec3 &low, const xlib::vec3 &scale, std::vector<unsigned short> &quantized) {
+		quantized.resize(vertexCount * 3);
+		float lowAxis[3] = { low.x, low.y, low.z };
+		float inverse[3] = { 1.0f / scale.x, 1.0f / scale.y, 1.0f / scale.z };
+		for (int i = 0; i < vertexCount * 3; i++) {
+			float q = (vertices[i] - lowAxis[i % 3]) * inverse[i % 3] + 0.5f;
+			quantized[i] = (unsigned short)xlib::fclamp(q, 0, 65535);
+		}
+	}
+
+	//Method designed to write a frame, indices is NULL for keyframes
+	void write(std::vector<unsigned char> &out, unsigned int frame, unsigned int keyframe, int vertexCount, const xlib::vec3 &low, const xlib::vec3 &scale,
+		int changedCount, const int *indices, const unsigned char *colors) const {
+		size_t indexBytes = indices ? changedCount * sizeof(unsigned int) : 0;
+		size_t positionBytes = (changedCount * 3 * sizeof(unsigned short) + 3) & ~(size_t)3;
+		out.resize(FRAME_HEADER_WORDS * 4 + indexBytes + positionBytes + changedCount * 3);
+
+		unsigned char *data = out.data();
+		unsigned int header[4] = { frame, keyframe, (unsigned int)vertexCount, (unsigned int)changedCount };
+		float box[6] = { low.x, low.y, low.z, scale.x, scale.y, scale.z };
+		memcpy(data, header, sizeof(header));
+		memcpy(data + sizeof(header), box, sizeof(box));
+		data += FRAME_HEADER_WORDS * 4;
+
+		unsigned int *index = (unsigned int*)data;
+		unsigned short *position = (unsigned short*)(data + indexBytes);
+		unsigned char *color = data + indexBytes + positionBytes;
+		memset(position, 0, positionBytes);
+		for (int c = 0; c < changedCount; c++) {
+			int v = indices ? indices[c] : c;
+			if (indices) {
+				index[c] = v;
+			}
+			memcpy(&position[c * 3], &positions[v * 3], 3 * sizeof(unsigned short));
+			memcpy(&color[c * 3], &colors[v * 3], 3);
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,99 @@
+/**
+* framesampler.h
+* @fileoverview .h file designed to pick the particles shown in a display frame that has a vertex budget
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef FRAMESAMPLER_H
+#define FRAMESAMPLER_H
+
+#include <vector>
+
+//Picks at most budget particles spread over the grid cells the particles are in
+//
+//Every occupied cell keeps at least one particle, so thin parts of the flow stay visible, and the rest of the budget is
+//shared out in proportion to the number of particles of each cell. Inside a cell the particles are taken evenly from its
+//index ordered list. Only particles changing cells change the picks, so consecutive frames mostly show the same particles
+//and stay cheap to send as deltas. When there are more occupied cells than the budget every n-th cell shows one particle.
+struct FrameSampler {
+
+	//Method designed to fill selected with the picked particles in increasing index order
+	//homeCells[i * stride] is the grid cell of particle i, or negative for particles that are not shown
+	void sample(const int *homeCells, int stride, int particleCount, int cellCount, int budget, std::vector<int> &selected) {
+		selected.clear();
+
+		//counting sort of the particles by cell, index order is kept inside every cell
+		cellStart.assign(cellCount + 1, 0);
+		int shown = 0;
+		for (int i = 0; i < particleCount; i++) {
+			int cell = homeCells[i * stride];
+			if (cell >= 0) {
+				cellStart[cell + 1]++;
+				shown++;
+			}
+		}
+		if (shown <= budget) {
+			for (int i = 0; i < particleCount; i++) {
+				if (homeCells[i * stride] >= 0) {
+					selected.push_back(i);
+				}
+			}
+			return;
+		}
+		int occupied = 0;
+		for (int c = 0; c < cellCount; c++) {
+			occupied += cellStart[c + 1] > 0 ? 1 : 0;
+			cellStart[c + 1] += cellStart[c];
+		}
+		sorted.resize(shown);
+		for (int i = 0; i < particleCount; i++) {
+			int cell = homeCells[i * stride];
+			if (cell >= 0) {
+				sorted[cellStart[cell]++] = i;
+			}
+		}
+		for (int c = cellCount; c > 0; c--) {
+			cellStart[c] = cellStart[c - 1];
+		}
+		cellStart[0] = 0;
+
+		//mark the picks so they can be listed in index order
+		picked.assign(particleCount, 0);
+		long long share = 0;
+		for (int c = 0; c < cellCount; c++) {
+			int count = cellStart[c + 1] - cellStart[c];
+			if (count == 0) {
+				continue;
+			}
+			int quota;
+			if (occupied >= budget) {
+				share += budget;
+				quota = share >= occupied ? 1 : 0;
+				share -= quota * occupied;
+			}
+			else {
+				//the share carried from cell to cell hands out exactly budget - occupied extra picks
+				share += (long long)(count - 1) * (budget - occupied);
+				int extra = (int)(share / (shown - occupied));
+				share -= (long long)extra * (shown - occupied);
+				quota = 1 + extra;
+			}
+			for (int k = 0; k < quota; k++) {
+				picked[sorted[cellStart[c] + (int)((long long)k * count / quota)]] = 1;
+			}
+		}
+		for (int i = 0; i < particleCount; i++) {
+			if (picked[i]) {
+				selected.push_back(i);
+			}
+		}
+	}
+
+private:
+	std::vector<int> cellStart;			//offset of the first particle of every cell in sorted
+	std::vector<int> sorted;			//shown particles ordered by cell
+	std::vector<unsigned char> picked;	//1 for every particle in the current frame
+};
+
+#endif
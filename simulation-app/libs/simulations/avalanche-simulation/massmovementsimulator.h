@@ -11,11 +11,26 @@
 #define MASSMOVEMENTSIMULATOR_H
 
 #include "terrain.h"
+#include "terraincache.h"
 #include "particle.h"
+#include "particlestore.h"
+#include "particlekernels.h"
 #include "simulationsettings.h"
-#include "particlebucket.h"
+#include "particlegrid.h"
+#include "workerpool.h"
+#include "simulationlock.h"
+#include "simulationprofile.h"
+#include "frameencoder.h"
+#include "framesampler.h"
+#include "densitycolormap.h"
+#include "simulationcheckpoint.h"
 #include "xlib.h"
 
+#include <memory>
+
+#define RANDOM_STREAM_START			0	//random values used to place the particles
+#define RANDOM_STREAM_TURBULANCE	1	//random values used to scatter particles bouncing off the terrain
+
 struct MassMovementSimulator {
 
 	string elevationDEMFile;
@@ -23,7 +38,7 @@ struct MassMovementSimulator {
 	string startingZoneFile;
 	string flowPathOutputFile;
 	string pathFile;
-	string pathDistanceMapFile; //TODO
+	string pathDistanceMapFile;
 
 	float initialHeight;
 	float bounceFriction;
@@ -39,14 +54,48 @@ struct MassMovementSimulator {
 
 	int	  gridSize;
 	int	  maxIterations;
-
-	xlib::xarray<Particle> particles;				//the actual particles themselves
-	xlib::xarray<ParticleBucket> particleGrid;	//2d grid used for fluid dynamics calculations
+	int	  numThreads;				//number of workers used to step the simulation (1 runs serially)
+	bool  useSimd;					//use the SSE2/AVX2 particle kernels when the cpu supports them
+	float sleepVelocity;			//speed below which a particle resting on the terrain counts as settled
+	int	  sleepSteps;				//steps a particle has to stay settled before it is put to sleep (0 never sleeps)
+	unsigned int seed;				//seed of every random value of the simulation, equal seeds give bit identical runs
+	unsigned int stepCount;			//number of steps taken since the particles were initialized
+	int	  checkpointInterval;		//steps between the checkpoints kept in memory (0 keeps none)
+	int	  checkpointCount;			//number of checkpoints kept in memory, older ones are dropped
+	int	  frameBudget;				//most vertices in a display frame, particles are sampled per grid cell above it (0 shows every particle)
+	float meshTolerance;			//largest height error of the terrain meshes sent to clients, see terrainsimplifier.h (0 sends every cell)
+	float timeStep;					//seconds of motion integrated per step
+	bool  smoothTerrain;			//collide with the bilinear surface through the heightMap samples, see Terrain::traceSurface
+
+	ParticleStore particles;				//the actual particles themselves
+	ParticleGrid particleGrid;			//2d grid used for fluid dynamics calculations
 	xlib::ximage particleStart;			//input image for where the initial set of particles are created
-	xlib::ximage pathImage;				//input image for the actual flow path (used for training)
-	xlib::ximage pathDistanceMap;		//input image that applies distance transform on the pathImage
+	xlib::ximage pathImage;				//input image for the actual flow path (used for training), white inside the path
+	xlib::ximage pathDistanceMap;		//input image that applies distance transform on the pathImage, brighter further from the path
 	xlib::ximage forceMap;				//output image that accumulates the motion of the particles
-	Terrain terrain;				//terrain map generated from the input DEM data
+	std::shared_ptr<const Terrain> terrain;	//terrain map generated from the input DEM data, shared between simulations
+
+	xlib::xarray<int> particleCells;		//grid cells each particle registered to during the last step (4 per particle, -1 if none)
+	xlib::xrandom random;					//counter based generator keyed by seed, drawn with (particle, step, RANDOM_STREAM_*)
+	xlib::xarray<int> particleFlags;		//PARTICLE_ACTIVE / PARTICLE_COLLIDED / PARTICLE_SLEEPING state of each particle
+	xlib::xarray<int> particleRestSteps;	//number of consecutive steps each awake particle has been settled
+	xlib::xarray<int> workerGridChanges;	//particles each worker added to or removed from the grid during the current step
+	xlib::xarray<float> particleDensity;	//scaled grid density at each particle before it moved this step
+	xlib::xarray<xlib::vec3> cellVelocity;	//average particle velocity of each grid cell
+	xlib::xarray<unsigned char> cellMoving;	//1 if a grid cell holds an awake particle faster than sleepVelocity
+	vector<xlib::xarray<float> > workerForceMaps;	//plain float forceMap accumulation buffer of every worker, only summed into forceMap by resolveForceMap
+	std::shared_ptr<WorkerPool> workerPool;	//created on the first parallel step
+	SimulationLock stepLock;				//held while the simulation is stepped or its settings are changed
+	SimulationProfile profile;				//time spent in each phase of a step, only measured while profile.enabled is set
+
+	xlib::xarray<float> frameVertices;		//x,y,z of every vertex of the last display frame
+	xlib::xarray<unsigned char> frameColors;	//r,g,b of every vertex of the last display frame
+	FrameEncoder frameEncoder;				//keyframe/delta state of the encoded frames sent to the client
+	FrameSampler frameSampler;				//picks the particles of display frames when frameBudget is set
+	std::vector<int> frameParticles;		//particle shown by every vertex of the last display frame
+	DensityColorMap densityColors;			//colors of the display frame particles by the density of their grid cell
+	xlib::xarray<unsigned char> cellColors;	//densityColors entry of every grid cell, computed once per display frame
+	CheckpointRing checkpoints;				//checkpoints of the last checkpointCount * checkpointInterval steps
 
 	//Constructor
 	MassMovementSimulator() {
@@ -65,23 +114,37 @@ struct MassMovementSimulator {
 		verboseOutput = true;
 		maxIterations = 20000;
 		framesPerSecond = 1;
+		numThreads = 1;
+		useSimd = true;
+		sleepVelocity = 0.05;
+		sleepSteps = 30;
+		seed = 1;
+		stepCount = 0;
+		checkpointInterval = 0;
+		checkpointCount = 30;
+		frameBudget = 0;
+		meshTolerance = 0;
+		timeStep = 0.1667;
+		smoothTerrain = false;
 	}
 
-	//Method designed to initialize the terrain
+	//Method designed to initialize the terrain, sharing it with every other simulation using the same files
 	void initTerrain() {
-		terrain.loadFrom_DEM_ASCII(elevationDEMFile);
-		terrain.terrainColor.importFrom_BMP(terrainColorFile);
-		terrain.terrainColor = terrain.terrainColor.resizedTo(512, 512);
+		terrain = TerrainCache::instance().get(elevationDEMFile, terrainColorFile);
 	}
 
-	//TODO clean up
 	//Method designed to initialize the particles
 	void initParticles() {
 		//create all the particles for the simulator
 		cout << "Initializing Particles" << endl;
-		forceMap.fill(xlib::vec4(0, 0, 0, 0));
 		particleStart.importFrom_BMP(startingZoneFile);
+		placeParticles();
+	}
 
+	//TODO clean up
+	//Method designed to create the particles from the already loaded particleStart image
+	//Simulations sharing a start zone copy its image and call this instead of initParticles()
+	void placeParticles() {
 		//particleStart = particleStart.convertedTo(XIMAGE_FORMAT_RGB24);
 		forceMap = xlib::ximage(particleStart.width(), particleStart.height(), 1, XIMAGE_FORMAT_GRAYSCALE_FLOAT32);
 		forceMap.fill(xlib::vec4(0, 0, 0, 0));
@@ -93,7 +156,9 @@ struct MassMovementSimulator {
 				numParticles += nParticles;
 			}
 		}
-		particles = xlib::xarray<Particle>(numParticles);
+		particles = ParticleStore(numParticles);
+		random = xlib::xrandom(seed);
+		stepCount = 0;
 		int index = 0;
 		for (int i = 0; i < particleStart.width(); i++) {
 			for (int j = 0; j < particleStart.height(); j++) {
@@ -101,44 +166,126 @@ struct MassMovementSimulator {
 				for (int p = 0; p < nParticles; p++) {
 					xlib::vec3 randval(0, 0, 0);
 					for (int r = 0; r < 4; r++) {
-						randval.x += (xlib::frand() - 0.5) / 2.0;
-						randval.y += (xlib::frand() - 0.5) / 2.0;
-						randval.z += (xlib::frand() - 0.5) / 2.0;
+						float jitter[4];
+						random.block(index, r, RANDOM_STREAM_START, jitter);
+						randval.x += (jitter[0] - 0.5) / 2.0;
+						randval.y += (jitter[1] - 0.5) / 2.0;
+						randval.z += (jitter[2] - 0.5) / 2.0;
 					}
 
-					int x = terrain.heightMap.size_y() * i / particleStart.width();
-					int y = terrain.heightMap.size_x() - terrain.heightMap.size_x() * j / particleStart.height();
-					particles[index].position = xlib::vec3(randval.x * terrain.cellSize + x * terrain.cellSize, terrain.heightMap(y, x) + initialHeight, randval.z * terrain.cellSize + y * terrain.cellSize);
-					particles[index].velocity = xlib::vec3(0, 0, 0);
+					int x = terrain->heightMap.size_y() * i / particleStart.width();
+					int y = terrain->heightMap.size_x() - terrain->heightMap.size_x() * j / particleStart.height();
+					particles.setPosition(index, xlib::vec3(randval.x * terrain->cellSize + x * terrain->cellSize, terrain->heightMap(y, x) + initialHeight, randval.z * terrain->cellSize + y * terrain->cellSize));
+					particles.setVelocity(index, xlib::vec3(0, 0, 0));
 					index++;
 				}
 			}
 		}
+		particleCells = xlib::xarray<int>(numParticles * 4);
+		particleCells.fill(-1);
+		particleFlags = xlib::xarray<int>(numParticles);
+		particleFlags.fill(0);
+		particleRestSteps = xlib::xarray<int>(numParticles);
+		particleRestSteps.fill(0);
+		workerGridChanges = xlib::xarray<int>(64);
+		workerGridChanges.fill(0);
+		particleDensity = xlib::xarray<float>(numParticles);
+		workerForceMaps.clear();
+		checkpoints.clear();
 		resetGrid();
 	}
 
-	//Method designed to clear all the particles from the grid
-	void clearGrid() {
-		for (int i = 0; i < particleGrid.size_x(); i++) {
-			for (int j = 0; j < particleGrid.size_y(); j++) {
-				particleGrid(i, j).particles.clear();
+	//Method designed to load the observed flow path and its distance map used to score the simulation
+	//Either file may be missing, in which case hasPath() is false and the simulation cannot be scored
+	void initPath() {
+		pathImage = xlib::ximage();
+		pathDistanceMap = xlib::ximage();
+		pathImage.importFrom_BMP(pathFile);
+		pathDistanceMap.importFrom_BMP(pathDistanceMapFile);
+	}
+
+	//Method designed to return whether the path images are loaded and line up with the forceMap
+	bool hasPath() const {
+		return pathImage.width() == forceMap.width() && pathImage.height() == forceMap.height()
+			&& pathDistanceMap.width() == forceMap.width() && pathDistanceMap.height() == forceMap.height() && forceMap.width() > 0;
+	}
+
+	//Method designed to score the accumulated forceMap against the observed path, lower is better and 0 is a perfect fit
+	//The error adds the forceMap weighted mean of the normalized path distance (flow that spills beside the path)
+	//to the fraction of path pixels no particle moved through (path the flow did not reach), so both terms lie in [0, 1]
+	//Returns -1 if hasPath() is false
+	double pathError() {
+		if (!hasPath()) {
+			return -1;
+		}
+		resolveForceMap();
+		const float *force = (const float*)forceMap.getDataSource();
+		double forceSum = 0, spill = 0;
+		int pathPixels = 0, missedPixels = 0;
+		for (int row = 0; row < forceMap.height(); row++) {
+			for (int col = 0; col < forceMap.width(); col++) {
+				float f = force[row * forceMap.width() + col];
+				forceSum += f;
+				spill += f * pathDistanceMap.getPixel(col, row).x;
+				if (pathImage.getPixel(col, row).x > 0.5) {
+					pathPixels++;
+					if (f <= 0) {
+						missedPixels++;
+					}
+				}
 			}
 		}
+		spill = forceSum > 0 ? spill / forceSum : 1.0;
+		return spill + (pathPixels > 0 ? double(missedPixels) / pathPixels : 0.0);
+	}
+
+	//Method designed to make sure the frame buffers can hold the given number of vertices
+	void reserveFrame(int vertexCount) {
+		if ((int)frameVertices.size() < vertexCount * 3) {
+			frameVertices = xlib::xarray<float>(vertexCount * 3);
+			frameColors = xlib::xarray<unsigned char>(vertexCount * 3);
+		}
+	}
+
+	//Method designed to list the particles of the next display frame in frameParticles and return their count
+	//A budget of 0 shows every particle, otherwise at most budget particles still on the terrain are picked
+	//by frameSampler from the grid cell each particle was registered to
+	int selectFrameParticles(int budget) {
+		if (budget <= 0) {
+			frameParticles.resize(particles.size());
+			for (int index = 0; index < particles.size(); index++) {
+				frameParticles[index] = index;
+			}
+		}
+		else {
+			frameSampler.sample(&particleCells[0], 4, particles.size(), particleGrid.size(), budget, frameParticles);
+		}
+		return frameParticles.size();
+	}
+
+	//Method designed to return the box display frames are quantized against, the terrain plus room for the particles to fall from
+	void frameBounds(xlib::vec3 &low, xlib::vec3 &high) const {
+		low = xlib::vec3(0, 0, 0);
+		high = xlib::vec3(terrain->heightMap.size_y() * terrain->cellSize, terrain->highestPoint() + (initialHeight > 0 ? initialHeight : 0), terrain->heightMap.size_x() * terrain->cellSize);
 	}
 
 	//Method designed to reset the particle grid with a new size
 	void resetGrid() {
-		particleGrid = xlib::xarray<ParticleBucket>(int(double(gridSize) * terrain.heightMap.size_x() / 512.0), int(double(gridSize) * terrain.heightMap.size_y() / 512.0));
+		particleGrid = ParticleGrid(int(double(gridSize) * terrain->heightMap.size_x() / 512.0), int(double(gridSize) * terrain->heightMap.size_y() / 512.0));
+		cellVelocity = xlib::xarray<xlib::vec3>(particleGrid.size_x(), particleGrid.size_y());
+		cellMoving = xlib::xarray<unsigned char>(particleGrid.size_x(), particleGrid.size_y());
+		cellMoving.fill(0);
 	}
 
-	//Method designed to register a particle to a grid
+	//Method designed to record the four grid cells a particle belongs to
+	//The cells are only added to particleGrid by rebuildGrid() so the grid stays unchanged while particles are updated
 	void registerParticleToGrid(int i) {
 		float x, y;
 		int ix, iy;
 		float ex, ey;
 		int x1, y1;
-		x = particles[i].position.x * particleGrid.size_y() / (terrain.heightMap.size_y() * terrain.cellSize);
-		y = particles[i].position.z * particleGrid.size_x() / (terrain.heightMap.size_x() * terrain.cellSize);
+		x = particles.px[i] * particleGrid.size_y() / (terrain->heightMap.size_y() * terrain->cellSize);
+		y = particles.pz[i] * particleGrid.size_x() / (terrain->heightMap.size_x() * terrain->cellSize);
 
 		ix = x;
 		iy = y;
@@ -164,125 +311,521 @@ struct MassMovementSimulator {
 		x1 = xlib::clamp(x1, 0, (int)particleGrid.size_y() - 1);
 		y1 = xlib::clamp(y1, 0, (int)particleGrid.size_x() - 1);
 
-		particleGrid(iy, ix).particles.push_back(i);
-		particleGrid(iy, x1).particles.push_back(i);
-		particleGrid(y1, x1).particles.push_back(i);
-		particleGrid(y1, ix).particles.push_back(i);
+		int rowSize = particleGrid.size_y();
+		particleCells[4 * i + 0] = iy * rowSize + ix;
+		particleCells[4 * i + 1] = iy * rowSize + x1;
+		particleCells[4 * i + 2] = y1 * rowSize + x1;
+		particleCells[4 * i + 3] = y1 * rowSize + ix;
 	}
 
-	//Method designed to compute the particle density at a given (x, y) coordinate
-	float computeDensity(float x, float z) {
-		x = x * particleGrid.size_y() / (terrain.heightMap.size_y() * terrain.cellSize);
-		z = z * particleGrid.size_x() / (terrain.heightMap.size_x() * terrain.cellSize);
+	//Method designed to refill the grid from the cells recorded by registerParticleToGrid
+	//Particles are added in index order so every cell matches a serial registration
+	void rebuildGrid() {
+		particleGrid.build(&particleCells[0], particleCells.size(), 4);
+	}
+
+	//Method designed to return the grid cell the density at a given (x, y) coordinate is taken from
+	int densityCell(float x, float z) const {
+		x = x * particleGrid.size_y() / (terrain->heightMap.size_y() * terrain->cellSize);
+		z = z * particleGrid.size_x() / (terrain->heightMap.size_x() * terrain->cellSize);
 		int i, j;
 		i = (int)x;
 		i = xlib::clamp(i, 0, (int)particleGrid.size_y() - 1);
 		j = (int)z;
 		j = xlib::clamp(j, 0, (int)particleGrid.size_x() - 1);
-		float cellSize = terrain.cellSize / particleGrid.size_y();
-		return ((float)particleGrid(j, i).particles.size()) / (cellSize * cellSize);
+		return j * particleGrid.size_y() + i;
 	}
 
-	//Method designed to update the grid
-	void updateGrid() {
-		for (int i = 0; i < particleGrid.size_x(); i++) {
+	//Method designed to compute the particle density at a given (x, y) coordinate
+	float computeDensity(float x, float z) {
+		float cellSize = terrain->cellSize / particleGrid.size_y();
+		return ((float)particleGrid.count(densityCell(x, z))) / (cellSize * cellSize);
+	}
+
+	//Method designed to find the densityColors entry of every grid cell, so a display frame only gathers the color of each particle
+	void computeCellColors() {
+		if ((int)cellColors.size() != particleGrid.size()) {
+			cellColors = xlib::xarray<unsigned char>(particleGrid.size());
+		}
+		float cellSize = terrain->cellSize / particleGrid.size_y();
+		for (int cell = 0; cell < particleGrid.size(); cell++) {
+			cellColors[cell] = DensityColorMap::entry(((float)particleGrid.count(cell)) / (cellSize * cellSize));
+		}
+	}
+
+	//Method designed to compute the average velocity of every grid cell in rows [begin, end)
+	//and whether the cell holds a moving particle that wakes the sleeping particles in it
+	void computeCellVelocities(int begin, int end) {
+		float wakeSpeedSqr = sleepVelocity * sleepVelocity;
+		for (int i = begin; i < end; i++) {
 			for (int j = 0; j < particleGrid.size_y(); j++) {
-				if (particleGrid(i, j).particles.empty()) {
-					continue;
+				int cell = i * particleGrid.size_y() + j;
+				const int *bucket = particleGrid.particles(cell);
+				int count = particleGrid.count(cell);
+				xlib::vec3 avgVel(0, 0, 0);
+				unsigned char moving = 0;
+				for (int p = 0; p < count; p++) {
+					xlib::vec3 velocity = particles.velocity(bucket[p]);
+					avgVel += velocity;
+					if (!(particleFlags[bucket[p]] & PARTICLE_SLEEPING) && velocity.lengthSqr() >= wakeSpeedSqr) {
+						moving = 1;
+					}
 				}
+				cellMoving[cell] = moving;
 
-				xlib::vec3 avgVel(0, 0, 0);
-				float count = 0;
-				float energy = 0;
-				float cellSize = terrain.cellSize / particleGrid.size_y();
-
-				for (int p = 0; p < particleGrid(i, j).particles.size(); p++) {
-					float dist = xlib::vec3(particles[particleGrid(i, j).particles[p]].position -
-						xlib::vec3(j * particleGrid.size_y() / (terrain.heightMap.size_y()*terrain.cellSize),
-						particles[particleGrid(i, j).particles[p]].position.y,
-						i * particleGrid.size_x() / (terrain.heightMap.size_x() * terrain.cellSize))
-						).lengthSqr();
-
-					avgVel += particles[particleGrid(i, j).particles[p]].velocity;
-					count += 1.0;
+				//TODO divide avgVel by frame rate to get velocity per frame
+
+				if (count > 0) {
+					avgVel /= (float)count;
 				}
-				if (count <= 0.01) {
+				cellVelocity(i, j) = avgVel;
+			}
+		}
+	}
+
+	//Method designed to pull the velocity of particles [begin, end) towards the average of their grid cells
+	//Cells are applied in row major order, the same order a serial sweep over the grid would visit them
+	//Sleeping particles are left alone unless one of their cells holds a moving particle, which wakes them
+	void applyCellVelocities(int begin, int end) {
+		for (int index = begin; index < end; index++) {
+			if (particleFlags[index] & PARTICLE_SLEEPING) {
+				bool woken = false;
+				for (int k = 0; k < 4; k++) {
+					int cell = particleCells[4 * index + k];
+					woken = woken || (cell >= 0 && cellMoving[cell]);
+				}
+				if (!woken) {
 					continue;
 				}
+				particleFlags[index] &= ~PARTICLE_SLEEPING;
+			}
 
-				//TODO divide avgVel by frame rate to get velocity per frame
+			int cells[4];
+			int numCells = 0;
+			for (int k = 0; k < 4; k++) {
+				int cell = particleCells[4 * index + k];
+				if (cell < 0) {
+					continue;
+				}
+				int c = numCells++;
+				while (c > 0 && cells[c - 1] > cell) {
+					cells[c] = cells[c - 1];
+					c--;
+				}
+				cells[c] = cell;
+			}
+
+			if (numCells == 0) {
+				continue;
+			}
+			xlib::vec3 velocity = particles.velocity(index);
+			for (int k = 0; k < numCells; k++) {
+				float count = particleGrid.count(cells[k]);
+				xlib::vec3 &avgVel = cellVelocity[cells[k]];
+				velocity += -avgVel * (viscosity / (count));
+				velocity = velocity * (1.0 - clumpingFactor) + avgVel * clumpingFactor;
+			}
+			particles.setVelocity(index, velocity);
+			updateRest(index);
+		}
+	}
+
+	//Method designed to count the steps an awake particle has been resting on the terrain and put it to sleep after sleepSteps
+	//A sleeping particle keeps its grid cells, so it still counts towards the density of the grid
+	void updateRest(int index) {
+		xlib::vec3 velocity = particles.velocity(index);
+		if (sleepSteps <= 0 || !(particleFlags[index] & PARTICLE_COLLIDED) || velocity.lengthSqr() >= sleepVelocity * sleepVelocity) {
+			particleRestSteps[index] = 0;
+			return;
+		}
+		if (++particleRestSteps[index] >= sleepSteps) {
+			particleRestSteps[index] = 0;
+			particleFlags[index] = PARTICLE_SLEEPING;
+			particles.setVelocity(index, xlib::vec3(0, 0, 0));
+		}
+	}
 
-				avgVel /= count;
+	//Method designed to wake every sleeping particle, used when a setting that changes their motion is modified
+	void wakeParticles() {
+		for (int index = 0; index < (int)particleFlags.size(); index++) {
+			particleFlags[index] &= ~PARTICLE_SLEEPING;
+			particleRestSteps[index] = 0;
+		}
+	}
+
+	//Method designed to return the number of sleeping particles
+	int sleepingParticles() const {
+		int count = 0;
+		for (int index = 0; index < (int)particleFlags.size(); index++) {
+			if (particleFlags[index] & PARTICLE_SLEEPING) {
+				count++;
+			}
+		}
+		return count;
+	}
+
+	//Method designed to return the number of particles updated by the last step
+	int activeParticles() const {
+		int count = 0;
+		for (int index = 0; index < (int)particleFlags.size(); index++) {
+			if (particleFlags[index] & PARTICLE_ACTIVE) {
+				count++;
+			}
+		}
+		return count;
+	}
 
-				for (int p = 0; p < particleGrid(i, j).particles.size(); p++) {
-					particles[particleGrid(i, j).particles[p]].velocity += -avgVel * (viscosity / (count));
-					particles[particleGrid(i, j).particles[p]].velocity = particles[particleGrid(i, j).particles[p]].velocity * (1.0 - clumpingFactor) + avgVel * clumpingFactor;
+	//Method designed to update the grid
+	//Cell averages are computed from the velocities at the start of the pass so cells can be processed independently
+	void updateGrid() {
+		parallelFor(particleGrid.size_x(), [this](int worker, int begin, int end) {
+			computeCellVelocities(begin, end);
+		});
+		parallelFor(particles.size(), [this](int worker, int begin, int end) {
+			applyCellVelocities(begin, end);
+		});
+	}
+
+	//Method designed to return the number of workers to use for a job of the given size
+	int workerCount(int count) {
+		int workers = xlib::clamp(numThreads, 1, 64);
+		if (workers > count) {
+			workers = count > 0 ? count : 1;
+		}
+		return workers;
+	}
+
+	//Method designed to split [0, count) into one contiguous range per worker and run job(worker, begin, end) on each
+	void parallelFor(int count, const std::function<void(int, int, int)> &job) {
+		int workers = workerCount(count);
+		if (workers <= 1) {
+			job(0, 0, count);
+			return;
+		}
+		if (!workerPool || workerPool->size() != xlib::clamp(numThreads, 1, 64)) {
+			workerPool = std::make_shared<WorkerPool>(xlib::clamp(numThreads, 1, 64));
+		}
+		workerPool->run([&](int worker) {
+			if (worker >= workers) {
+				return;
+			}
+			int begin, end;
+			WorkerPool::range(worker, workers, count, begin, end);
+			job(worker, begin, end);
+		});
+	}
+
+	//Method designed to return the forceMap accumulation buffer of a worker
+	//Every worker owns its buffer, so particles are accumulated without locks or atomics
+	float* workerForceMap(int worker) {
+		while ((int)workerForceMaps.size() <= worker) {
+			xlib::xarray<float> buffer(forceMap.width() * forceMap.height());
+			buffer.fill(0);
+			workerForceMaps.push_back(std::move(buffer));
+		}
+		return &workerForceMaps[worker][0];
+	}
+
+	//Method designed to add the worker buffers into forceMap in worker order and clear them
+	//Must be called before forceMap is read, the buffers are not reduced while the simulation is stepped
+	void resolveForceMap() {
+		float *target = (float*)forceMap.getDataSource();
+		int buffers = workerForceMaps.size();
+		parallelFor(forceMap.width() * forceMap.height(), [&](int worker, int begin, int end) {
+			for (int w = 0; w < buffers; w++) {
+				float *buffer = &workerForceMaps[w][0];
+				for (int p = begin; p < end; p++) {
+					target[p] += buffer[p];
+					buffer[p] = 0;
 				}
 			}
+		});
+	}
+
+	//Method designed to export the accumulated forceMap to flowPathOutputFile as a bitmap
+	void exportFlowPath() {
+		resolveForceMap();
+		string fileName = flowPathOutputFile;
+		if (fileName.size() < 4 || fileName.compare(fileName.size() - 4, 4, ".bmp") != 0) {
+			fileName += ".bmp";
 		}
+		cout << "Exporting flow path to: " << fileName << endl;
+		forceMap.exportAs_BMP(fileName);
 	}
 
 	//Method designed to update all particles
+	//Every step reads the grid built by the previous step and random values only depend on (seed, particle, step),
+	//so results do not depend on numThreads or on the kernels used
 	void updateAllParticles() {
-		clearGrid();
-		for (int index = 0; index < particles.size(); index++) {
-			updateParticle(index); //TODO determine if dtime is time per frame
+		int workers = workerCount(particles.size());
+		for (int worker = 0; worker < workers; worker++) {
+			workerForceMap(worker);
+		}
+		ParticleKernels kernels = ParticleKernels::select(useSimd);
+		parallelFor(particles.size(), [&](int worker, int begin, int end) {
+			updateParticles(kernels, worker, begin, end, workerForceMap(worker), timeStep);
+		});
+
+		long long start = profile.enabled ? SimulationProfile::now() : 0;
+
+		//once every particle is asleep or outside the terrain the grid and the cell velocities stop changing
+		int gridChanges = 0;
+		for (int worker = 0; worker < workers; worker++) {
+			gridChanges += workerGridChanges[worker];
+		}
+		if (gridChanges > 0) {
+			rebuildGrid();
+		}
+		if (profile.enabled) {
+			start = profile.add(0, PROFILE_REGISTER, start);
+		}
+		if (gridChanges > 0) {
+			updateGrid();
+		}
+		if (profile.enabled) {
+			profile.add(0, PROFILE_UPDATEGRID, start);
+			profile.steps++;
+			profile.particleSteps += particles.size();
+		}
+		stepCount++;
+
+		if (checkpointInterval > 0 && checkpointCount > 0 && stepCount % checkpointInterval == 0) {
+			saveCheckpoint(checkpoints.next(stepCount, checkpointCount));
 		}
-		updateGrid();
 	}
 
-	//TODO clean up
-	//method designed to update a particle
-	void updateParticle(int index, float dTime = 0.1667) {
-		Particle &particle = particles[index];
+	//Method designed to store the state of the simulation after the current step in a checkpoint
+	//Layout: a header of uint32 magic, version, particle count, forceMap width and height, stepCount and seed, the settings
+	//that change the motion of the particles, the particle streams, the flags, rest steps, grid cells and density of every
+	//particle and finally the forceMap including the worker buffers that were not resolved yet
+	//maxIterations and framesPerSecond only control how long and how fast the simulation runs and are not stored
+	//The simulation itself is not changed, so taking checkpoints does not change its results
+	void saveCheckpoint(SimulationCheckpoint &checkpoint) {
+		unsigned int count = particles.size();
+		unsigned int header[7] = { CHECKPOINT_MAGIC, CHECKPOINT_VERSION, count, (unsigned int)forceMap.width(), (unsigned int)forceMap.height(), stepCount, seed };
+		float settings[CHECKPOINT_SETTINGS];
+		int intSettings[CHECKPOINT_INT_SETTINGS];
+		motionSettings(settings, intSettings);
+		checkpoint.clear(stepCount);
+		checkpoint.write(header, sizeof(header));
+		checkpoint.write(settings, sizeof(settings));
+		checkpoint.write(intSettings, sizeof(intSettings));
+		checkpoint.write(particles.streams(), particles.streamBytes());
+		checkpoint.write(&particleFlags[0], count * sizeof(int));
+		checkpoint.write(&particleRestSteps[0], count * sizeof(int));
+		checkpoint.write(&particleCells[0], count * 4 * sizeof(int));
+		checkpoint.write(&particleDensity[0], count * sizeof(float));
+
+		size_t offset = checkpoint.data.size();
+		int pixels = forceMap.width() * forceMap.height();
+		checkpoint.write(forceMap.getDataSource(), pixels * sizeof(float));
+		float *force = (float*)&checkpoint.data[offset];
+		for (int w = 0; w < (int)workerForceMaps.size(); w++) {
+			const float *buffer = &workerForceMaps[w][0];
+			for (int p = 0; p < pixels; p++) {
+				force[p] += buffer[p];
+			}
+		}
+	}
 
-		if (particle.position.x < 0 || particle.position.z < 0 || particle.position.x > terrain.heightMap.size_y() * terrain.cellSize
-			|| particle.position.z > terrain.heightMap.size_x() * terrain.cellSize) {
-			return;
+	//Method designed to return the simulation to the state stored in a checkpoint
+	//Returns false without changing anything if the checkpoint was taken from a different terrain or start zone
+	bool restoreCheckpoint(const SimulationCheckpoint &checkpoint) {
+		unsigned int count = particles.size();
+		unsigned int header[7];
+		size_t offset = 0;
+		if (!checkpoint.read(offset, header, sizeof(header)) || header[0] != CHECKPOINT_MAGIC || header[1] != CHECKPOINT_VERSION
+			|| header[2] != count || header[3] != (unsigned int)forceMap.width() || header[4] != (unsigned int)forceMap.height()) {
+			return false;
+		}
+		int pixels = forceMap.width() * forceMap.height();
+		size_t expected = sizeof(header) + CHECKPOINT_SETTINGS * sizeof(float) + CHECKPOINT_INT_SETTINGS * sizeof(int) + particles.streamBytes() + count * 6 * sizeof(int) + count * sizeof(float) + pixels * sizeof(float);
+		if (checkpoint.data.size() != expected) {
+			return false;
 		}
 
-		float bounceFriction = bounceFriction;
-		float stickyness = stickyness;
-		float damping = dampingForce;
-		float turbulance = turbulanceForce;
-		xlib::vec3 hit, norm;
+		float settings[CHECKPOINT_SETTINGS];
+		int intSettings[CHECKPOINT_INT_SETTINGS];
+		checkpoint.read(offset, settings, sizeof(settings));
+		checkpoint.read(offset, intSettings, sizeof(intSettings));
+		initialHeight = settings[0];
+		bounceFriction = settings[1];
+		stickyness = settings[2];
+		dampingForce = settings[3];
+		turbulanceForce = settings[4];
+		clumpingFactor = settings[5];
+		viscosity = settings[6];
+		sleepVelocity = settings[7];
+		timeStep = settings[8];
+		sleepSteps = intSettings[1];
+		smoothTerrain = intSettings[2] != 0;
+		if (gridSize != intSettings[0]) {
+			gridSize = intSettings[0];
+			resetGrid();
+		}
+
+		checkpoint.read(offset, particles.streams(), particles.streamBytes());
+		checkpoint.read(offset, &particleFlags[0], count * sizeof(int));
+		checkpoint.read(offset, &particleRestSteps[0], count * sizeof(int));
+		checkpoint.read(offset, &particleCells[0], count * 4 * sizeof(int));
+		checkpoint.read(offset, &particleDensity[0], count * sizeof(float));
+		checkpoint.read(offset, forceMap.getDataSource(), pixels * sizeof(float));
+		for (int w = 0; w < (int)workerForceMaps.size(); w++) {
+			workerForceMaps[w].fill(0);
+		}
+
+		stepCount = header[5];
+		seed = header[6];
+		random = xlib::xrandom(seed);
+		rebuildGrid();
+		return true;
+	}
+
+	//Method designed to return whether a checkpoint was taken with the seed and the settings that change the motion of the
+	//particles this simulation has, restoring any other checkpoint would continue a different run
+	bool checkpointSettingsMatch(const SimulationCheckpoint &checkpoint) const {
+		unsigned int header[7];
+		float settings[CHECKPOINT_SETTINGS], current[CHECKPOINT_SETTINGS];
+		int intSettings[CHECKPOINT_INT_SETTINGS], currentInt[CHECKPOINT_INT_SETTINGS];
+		size_t offset = 0;
+		if (!checkpoint.read(offset, header, sizeof(header)) || header[0] != CHECKPOINT_MAGIC || header[1] != CHECKPOINT_VERSION
+			|| !checkpoint.read(offset, settings, sizeof(settings)) || !checkpoint.read(offset, intSettings, sizeof(intSettings))) {
+			return false;
+		}
+		motionSettings(current, currentInt);
+		return header[6] == seed && memcmp(settings, current, sizeof(settings)) == 0 && memcmp(intSettings, currentInt, sizeof(intSettings)) == 0;
+	}
+
+	//Method designed to fill the settings stored in a checkpoint, in the order restoreCheckpoint reads them
+	void motionSettings(float settings[CHECKPOINT_SETTINGS], int intSettings[CHECKPOINT_INT_SETTINGS]) const {
+		float values[CHECKPOINT_SETTINGS] = { initialHeight, bounceFriction, stickyness, dampingForce, turbulanceForce, clumpingFactor, viscosity, sleepVelocity, timeStep };
+		int intValues[CHECKPOINT_INT_SETTINGS] = { gridSize, sleepSteps, smoothTerrain ? 1 : 0 };
+		memcpy(settings, values, sizeof(values));
+		memcpy(intSettings, intValues, sizeof(intValues));
+	}
+
+	//Method designed to return to the in memory checkpoint of the given step, returns false if it is not stored
+	bool restoreCheckpoint(unsigned int step) {
+		const SimulationCheckpoint *checkpoint = checkpoints.find(step);
+		return checkpoint != NULL && restoreCheckpoint(*checkpoint);
+	}
+
+	//Method designed to write the current state to a checkpoint file, returns false if the file cannot be written
+	bool writeCheckpoint(const string &fileName) {
+		SimulationCheckpoint checkpoint;
+		saveCheckpoint(checkpoint);
+		return checkpoint.save(fileName);
+	}
+
+	//Method designed to continue from a checkpoint file, returns false if it cannot be read or does not fit the simulation
+	bool readCheckpoint(const string &fileName) {
+		SimulationCheckpoint checkpoint;
+		return checkpoint.load(fileName) && restoreCheckpoint(checkpoint);
+	}
+
+	//Method designed to update particles [begin, end), accumulating their motion into the given forceMap buffer
+	//Gravity and integration run as vector kernels over the whole range, terrain collisions are resolved per particle in between
+	void updateParticles(const ParticleKernels &kernels, int worker, int begin, int end, float *forceBuffer, float dTime = 0.1667) {
+		int *flags = &particleFlags[0];
+		long long start = profile.enabled ? SimulationProfile::now() : 0;
 
 		//NOTE: v = v0 + a*t
-		particle.velocity.y += dTime * -9.8;		
+		kernels.applyGravity(particles, flags, begin, end, terrain->heightMap.size_y() * terrain->cellSize, terrain->heightMap.size_x() * terrain->cellSize, dTime * -9.8);
+		if (profile.enabled) {
+			start = profile.add(worker, PROFILE_KERNELS, start);
+		}
+
+		for (int index = begin; index < end; index++) {
+			if (flags[index] & PARTICLE_ACTIVE) {
+				collideParticle(index, dTime);
+			}
+		}
+		if (profile.enabled) {
+			start = profile.add(worker, PROFILE_TRACE, start);
+		}
 
-		bool collision = terrain.trace(particle.position, particle.position + particle.velocity * dTime, hit, norm);
+		kernels.integrate(particles, flags, begin, end, dampingForce, dTime);		//damp free particles and apply velocity to position
+		if (profile.enabled) {
+			start = profile.add(worker, PROFILE_KERNELS, start);
+		}
 
-		float density = computeDensity(particle.position.x, particle.position.z) * 0.0001;
+		int gridChanges = 0;
+		for (int index = begin; index < end; index++) {
+			if (flags[index] & PARTICLE_SLEEPING) {
+				continue;		//keeps the cells it registered to before it fell asleep
+			}
+			if (!(flags[index] & PARTICLE_ACTIVE)) {
+				if (particleCells[4 * index] >= 0) {
+					for (int k = 0; k < 4; k++) {
+						particleCells[4 * index + k] = -1;
+					}
+					gridChanges++;
+				}
+				continue;
+			}
+			registerParticleToGrid(index);
+			gridChanges++;
+		}
+		workerGridChanges[worker] = gridChanges;
+		if (profile.enabled) {
+			start = profile.add(worker, PROFILE_REGISTER, start);
+		}
 
-		if (!collision) {
-			particle.velocity += -particle.velocity * damping;
+		for (int index = begin; index < end; index++) {
+			if (flags[index] & PARTICLE_ACTIVE) {
+				accumulateForce(index, forceBuffer);
+			}
 		}
-		else {
-			float length = particle.velocity.length();
-			xlib::vec3 v = particle.velocity.normalized();
+		if (profile.enabled) {
+			profile.add(worker, PROFILE_FORCEMAP, start);
+		}
+	}
+
+	//TODO clean up
+	//Method designed to test an active particle against the terrain and bounce it off if it hits
+	void collideParticle(int index, float dTime) {
+		float bounceFriction = this->bounceFriction;
+		float stickyness = this->stickyness;
+		float turbulance = turbulanceForce;
+		xlib::vec3 position = particles.position(index);
+		xlib::vec3 velocity = particles.velocity(index);
+		xlib::vec3 hit, norm;
+
+		bool collision = smoothTerrain ? terrain->traceSurface(position, position + velocity * dTime, hit, norm) : terrain->trace(position, position + velocity * dTime, hit, norm);
+
+		float density = computeDensity(position.x, position.z) * 0.0001;
+		particleDensity[index] = density;
+
+		if (collision) {
+			float length = velocity.length();
+			xlib::vec3 v = velocity.normalized();
 			xlib::vec3 r = -(2.0 * (norm * v) * norm - v);
-			float dotNorm = r * norm;
-			if (particle.position.y < hit.y) {
-				particle.position.y += 0.5*(hit.y - particle.position.y);
+			if (position.y < hit.y) {
+				particles.py[index] += 0.5*(hit.y - position.y);
 			}
-			particle.velocity = (r)* length * (1.0 - bounceFriction) + length * xlib::vec3(xlib::frand() - 0.5, 0, xlib::frand() - 0.5) * turbulance * density;
+			float noise[4];
+			random.block(index, stepCount, RANDOM_STREAM_TURBULANCE, noise);
+			velocity = (r)* length * (1.0 - bounceFriction) + length * xlib::vec3(noise[0] - 0.5, 0, noise[1] - 0.5) * turbulance * density;
 			if (length * dTime < stickyness) {
-				particle.velocity *= 0.0;
+				velocity *= 0.0;
 			}
+			particles.setVelocity(index, velocity);
+			particleFlags[index] |= PARTICLE_COLLIDED;
 		}
-		particle.position += particle.velocity * dTime;			//apply velocity to position
-		registerParticleToGrid(index);
+	}
 
-		float xcoord = forceMap.width() * particle.position.x / (terrain.heightMap.size_y() * terrain.cellSize);
-		float ycoord = forceMap.height() - forceMap.height() * particle.position.z / (terrain.heightMap.size_x() * terrain.cellSize);
+	//Method designed to add the horizontal motion of a particle into the given forceMap buffer
+	void accumulateForce(int index, float *forceBuffer) {
+		float xcoord = forceMap.width() * particles.px[index] / (terrain->heightMap.size_y() * terrain->cellSize);
+		float ycoord = forceMap.height() - forceMap.height() * particles.pz[index] / (terrain->heightMap.size_x() * terrain->cellSize);
 
 		int xcoordi = xcoord;
 		int ycoordi = ycoord;
 		if (xcoordi < forceMap.width() - 1 && xcoordi >= 0 && ycoordi < forceMap.height() - 1 && ycoordi >= 0) {
-			xlib::vec3 force = particle.velocity&xlib::vec3(1, 0, 1);
+			xlib::vec3 force = particles.velocity(index)&xlib::vec3(1, 0, 1);
 			float mag = force.length();
-			float drawColor = density * mag * 0.00025;
-			*(float*)forceMap(xcoordi, ycoordi) += drawColor;
+			float drawColor = particleDensity[index] * mag * 0.00025;
+			forceBuffer[ycoordi * forceMap.width() + xcoordi] += drawColor;
 		}
 	}
 };
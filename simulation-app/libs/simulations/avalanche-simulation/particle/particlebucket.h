@@ -1,15 +0,0 @@
-/**
-* particlebucket.h
-* @fileoverview .h file designed to define a particle bucket struct
-* @author Unknown
-* Created: Unknown
-*/
-
-#ifndef PARTICLEBUCKET_H
-#define PARTICLEBUCKET_H
-
-struct ParticleBucket {
-	vector<int> particles;
-};
-
-#endif
\ No newline at end of file
@@ -0,0 +1,101 @@
+/**
+* particlegrid.h
+* @fileoverview .h file designed to define a cell list grid of particle indices
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef PARTICLEGRID_H
+#define PARTICLEGRID_H
+
+#include "xlib.h"
+
+//2d grid storing the particles of every cell back to back in one flat array
+//Cell (x, y) has the linear index x * size_y() + y, the same layout as xlib::xarray
+//The particles of cell c are particles[cellStart[c]] to particles[cellStart[c + 1] - 1]
+struct ParticleGrid {
+
+	//Constructors
+	ParticleGrid() {
+		_xsize = 0;
+		_ysize = 0;
+	}
+	ParticleGrid(int xsize, int ysize) {
+		_xsize = xsize;
+		_ysize = ysize;
+		_cellStart = xlib::xarray<int>(xsize * ysize + 1);
+		_cellStart.fill(0);
+	}
+
+	//Methods designed to return the dimensions of the grid
+	int size() const {
+		return _xsize * _ysize;
+	}
+	int size_x() const {
+		return _xsize;
+	}
+	int size_y() const {
+		return _ysize;
+	}
+
+	//Methods designed to return the number of particles in a cell
+	int count(int cell) const {
+		return _cellStart[cell + 1] - _cellStart[cell];
+	}
+	int count(int x, int y) const {
+		return count(x * _ysize + y);
+	}
+
+	//Method designed to return the first particle index of a cell, the rest follow contiguously
+	const int* particles(int cell) const {
+		return &_particles[0] + _cellStart[cell];
+	}
+
+	//Method designed to empty every cell
+	void clear() {
+		_cellStart.fill(0);
+	}
+
+	//Method designed to fill the grid from a list of (particle, cell) entries using a counting sort
+	//Entry i belongs to particle i / entriesPerParticle, entries with a negative cell are skipped
+	//Particles keep their index order inside each cell and no memory is allocated unless the entry count grows
+	void build(const int *entryCells, int entryCount, int entriesPerParticle) {
+		int cells = size();
+		if ((int)_particles.size() < entryCount) {
+			_particles = xlib::xarray<int>(entryCount);
+		}
+
+		//count the particles of every cell, shifted by one so the prefix sum gives the start offsets
+		_cellStart.fill(0);
+		for (int i = 0; i < entryCount; i++) {
+			if (entryCells[i] >= 0) {
+				_cellStart[entryCells[i] + 1]++;
+			}
+		}
+		for (int c = 0; c < cells; c++) {
+			_cellStart[c + 1] += _cellStart[c];
+		}
+
+		//scatter the particles, using cellStart[c] as the write cursor of cell c
+		for (int i = 0; i < entryCount; i++) {
+			int cell = entryCells[i];
+			if (cell >= 0) {
+				_particles[_cellStart[cell]++] = i / entriesPerParticle;
+			}
+		}
+
+		//every cursor now points at the start of the next cell, shift them back
+		for (int c = cells; c > 0; c--) {
+			_cellStart[c] = _cellStart[c - 1];
+		}
+		_cellStart[0] = 0;
+	}
+
+private:
+	int _xsize;
+	int _ysize;
+	xlib::xarray<int> _cellStart;	//offset of the first particle of every cell, plus the total count at the end
+	xlib::xarray<int> _particles;	//particle indices sorted by cell
+};
+
+#endif
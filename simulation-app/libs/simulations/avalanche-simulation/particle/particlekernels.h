@@ -0,0 +1,190 @@
+/**
+* particlekernels.h
+* @fileoverview .h file designed to provide the vectorized parts of the particle update
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef PARTICLEKERNELS_H
+#define PARTICLEKERNELS_H
+
+#include "particlestore.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define PARTICLEKERNELS_X86
+#include <immintrin.h>
+#endif
+
+#define PARTICLE_ACTIVE		1		//particle is inside the terrain and is updated this step
+#define PARTICLE_COLLIDED	2		//particle hit the terrain this step
+#define PARTICLE_SLEEPING	4		//particle has come to rest and is skipped until it is woken
+
+//Every kernel works on particles [begin, end) and uses the same float operations in the same order,
+//so the scalar and vector versions produce bit identical results
+
+//Method designed to flag the awake particles inside [0, maxX] x [0, maxZ] as active and apply gravity to them
+//Sleeping particles keep only their PARTICLE_SLEEPING flag and are left untouched
+void applyGravity_Scalar(ParticleStore &particles, int *flags, int begin, int end, float maxX, float maxZ, float gravityStep) {
+	for (int i = begin; i < end; i++) {
+		bool outside = particles.px[i] < 0 || particles.pz[i] < 0 || particles.px[i] > maxX || particles.pz[i] > maxZ;
+		bool sleeping = (flags[i] & PARTICLE_SLEEPING) != 0;
+		flags[i] = sleeping ? PARTICLE_SLEEPING : (outside ? 0 : PARTICLE_ACTIVE);
+		if (!outside && !sleeping) {
+			particles.vy[i] = particles.vy[i] + gravityStep;
+		}
+	}
+}
+
+//Method designed to damp the velocity of active particles that did not collide and move every active particle
+void integrate_Scalar(ParticleStore &particles, const int *flags, int begin, int end, float damping, float dTime) {
+	for (int i = begin; i < end; i++) {
+		if (flags[i] == PARTICLE_ACTIVE) {
+			particles.vx[i] = particles.vx[i] - particles.vx[i] * damping;
+			particles.vy[i] = particles.vy[i] - particles.vy[i] * damping;
+			particles.vz[i] = particles.vz[i] - particles.vz[i] * damping;
+		}
+		if (flags[i] & PARTICLE_ACTIVE) {
+			particles.px[i] = particles.px[i] + particles.vx[i] * dTime;
+			particles.py[i] = particles.py[i] + particles.vy[i] * dTime;
+			particles.pz[i] = particles.pz[i] + particles.vz[i] * dTime;
+		}
+	}
+}
+
+#ifdef PARTICLEKERNELS_X86
+
+//SSE2 version of applyGravity_Scalar
+void applyGravity_SSE2(ParticleStore &particles, int *flags, int begin, int end, float maxX, float maxZ, float gravityStep) {
+	__m128 zero = _mm_setzero_ps();
+	__m128 limitX = _mm_set1_ps(maxX);
+	__m128 limitZ = _mm_set1_ps(maxZ);
+	__m128 gravity = _mm_set1_ps(gravityStep);
+	__m128i active = _mm_set1_epi32(PARTICLE_ACTIVE);
+	__m128i sleepFlag = _mm_set1_epi32(PARTICLE_SLEEPING);
+	int i = begin;
+	for (; i + 4 <= end; i += 4) {
+		__m128 x = _mm_loadu_ps(particles.px + i);
+		__m128 z = _mm_loadu_ps(particles.pz + i);
+		__m128i sleeping = _mm_and_si128(_mm_loadu_si128((const __m128i*)(flags + i)), sleepFlag);
+		__m128 skip = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(x, zero), _mm_cmplt_ps(z, zero)),
+			_mm_or_ps(_mm_cmpgt_ps(x, limitX), _mm_cmpgt_ps(z, limitZ)));
+		skip = _mm_or_ps(skip, _mm_castsi128_ps(_mm_cmpeq_epi32(sleeping, sleepFlag)));
+
+		__m128 vy = _mm_loadu_ps(particles.vy + i);
+		vy = _mm_or_ps(_mm_and_ps(skip, vy), _mm_andnot_ps(skip, _mm_add_ps(vy, gravity)));
+		_mm_storeu_ps(particles.vy + i, vy);
+		_mm_storeu_si128((__m128i*)(flags + i), _mm_or_si128(_mm_andnot_si128(_mm_castps_si128(skip), active), sleeping));
+	}
+	applyGravity_Scalar(particles, flags, i, end, maxX, maxZ, gravityStep);
+}
+
+//SSE2 version of integrate_Scalar
+void integrate_SSE2(ParticleStore &particles, const int *flags, int begin, int end, float damping, float dTime) {
+	__m128 damp = _mm_set1_ps(damping);
+	__m128 dt = _mm_set1_ps(dTime);
+	__m128i active = _mm_set1_epi32(PARTICLE_ACTIVE);
+	float *position[3] = { particles.px, particles.py, particles.pz };
+	float *velocity[3] = { particles.vx, particles.vy, particles.vz };
+	int i = begin;
+	for (; i + 4 <= end; i += 4) {
+		__m128i f = _mm_loadu_si128((const __m128i*)(flags + i));
+		__m128 isFree = _mm_castsi128_ps(_mm_cmpeq_epi32(f, active));
+		__m128 isActive = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(f, active), active));
+		for (int c = 0; c < 3; c++) {
+			__m128 v = _mm_loadu_ps(velocity[c] + i);
+			__m128 damped = _mm_sub_ps(v, _mm_mul_ps(v, damp));
+			v = _mm_or_ps(_mm_and_ps(isFree, damped), _mm_andnot_ps(isFree, v));
+			_mm_storeu_ps(velocity[c] + i, v);
+
+			__m128 p = _mm_loadu_ps(position[c] + i);
+			__m128 moved = _mm_add_ps(p, _mm_mul_ps(v, dt));
+			_mm_storeu_ps(position[c] + i, _mm_or_ps(_mm_and_ps(isActive, moved), _mm_andnot_ps(isActive, p)));
+		}
+	}
+	integrate_Scalar(particles, flags, i, end, damping, dTime);
+}
+
+//AVX2 version of applyGravity_Scalar
+__attribute__((target("avx2")))
+void applyGravity_AVX2(ParticleStore &particles, int *flags, int begin, int end, float maxX, float maxZ, float gravityStep) {
+	__m256 zero = _mm256_setzero_ps();
+	__m256 limitX = _mm256_set1_ps(maxX);
+	__m256 limitZ = _mm256_set1_ps(maxZ);
+	__m256 gravity = _mm256_set1_ps(gravityStep);
+	__m256i active = _mm256_set1_epi32(PARTICLE_ACTIVE);
+	__m256i sleepFlag = _mm256_set1_epi32(PARTICLE_SLEEPING);
+	int i = begin;
+	for (; i + 8 <= end; i += 8) {
+		__m256 x = _mm256_loadu_ps(particles.px + i);
+		__m256 z = _mm256_loadu_ps(particles.pz + i);
+		__m256i sleeping = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(flags + i)), sleepFlag);
+		__m256 skip = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(x, zero, _CMP_LT_OQ), _mm256_cmp_ps(z, zero, _CMP_LT_OQ)),
+			_mm256_or_ps(_mm256_cmp_ps(x, limitX, _CMP_GT_OQ), _mm256_cmp_ps(z, limitZ, _CMP_GT_OQ)));
+		skip = _mm256_or_ps(skip, _mm256_castsi256_ps(_mm256_cmpeq_epi32(sleeping, sleepFlag)));
+
+		__m256 vy = _mm256_loadu_ps(particles.vy + i);
+		_mm256_storeu_ps(particles.vy + i, _mm256_blendv_ps(_mm256_add_ps(vy, gravity), vy, skip));
+		_mm256_storeu_si256((__m256i*)(flags + i), _mm256_or_si256(_mm256_andnot_si256(_mm256_castps_si256(skip), active), sleeping));
+	}
+	applyGravity_Scalar(particles, flags, i, end, maxX, maxZ, gravityStep);
+}
+
+//AVX2 version of integrate_Scalar
+__attribute__((target("avx2")))
+void integrate_AVX2(ParticleStore &particles, const int *flags, int begin, int end, float damping, float dTime) {
+	__m256 damp = _mm256_set1_ps(damping);
+	__m256 dt = _mm256_set1_ps(dTime);
+	__m256i active = _mm256_set1_epi32(PARTICLE_ACTIVE);
+	float *position[3] = { particles.px, particles.py, particles.pz };
+	float *velocity[3] = { particles.vx, particles.vy, particles.vz };
+	int i = begin;
+	for (; i + 8 <= end; i += 8) {
+		__m256i f = _mm256_loadu_si256((const __m256i*)(flags + i));
+		__m256 isFree = _mm256_castsi256_ps(_mm256_cmpeq_epi32(f, active));
+		__m256 isActive = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(f, active), active));
+		for (int c = 0; c < 3; c++) {
+			__m256 v = _mm256_loadu_ps(velocity[c] + i);
+			v = _mm256_blendv_ps(v, _mm256_sub_ps(v, _mm256_mul_ps(v, damp)), isFree);
+			_mm256_storeu_ps(velocity[c] + i, v);
+
+			__m256 p = _mm256_loadu_ps(position[c] + i);
+			_mm256_storeu_ps(position[c] + i, _mm256_blendv_ps(p, _mm256_add_ps(p, _mm256_mul_ps(v, dt)), isActive));
+		}
+	}
+	integrate_Scalar(particles, flags, i, end, damping, dTime);
+}
+
+#endif
+
+//Set of kernels picked at runtime for the instruction sets supported by the cpu
+struct ParticleKernels {
+	void(*applyGravity)(ParticleStore&, int*, int, int, float, float, float);
+	void(*integrate)(ParticleStore&, const int*, int, int, float, float);
+	const char *name;
+
+	//Method designed to return the fastest kernels available, or the scalar ones if allowSimd is false
+	static ParticleKernels select(bool allowSimd) {
+		ParticleKernels kernels;
+		kernels.applyGravity = applyGravity_Scalar;
+		kernels.integrate = integrate_Scalar;
+		kernels.name = "scalar";
+#ifdef PARTICLEKERNELS_X86
+		if (allowSimd) {
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2")) {
+				kernels.applyGravity = applyGravity_AVX2;
+				kernels.integrate = integrate_AVX2;
+				kernels.name = "avx2";
+			}
+			else {
+				kernels.applyGravity = applyGravity_SSE2;
+				kernels.integrate = integrate_SSE2;
+				kernels.name = "sse2";
+			}
+		}
+#endif
+		return kernels;
+	}
+};
+
+#endif
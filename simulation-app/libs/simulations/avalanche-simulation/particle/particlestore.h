@@ -0,0 +1,153 @@
+/**
+* particlestore.h
+* @fileoverview .h file designed to store particles as separate position and velocity streams
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef PARTICLESTORE_H
+#define PARTICLESTORE_H
+
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include "particle.h"
+#include "xlib.h"
+
+#define PARTICLESTORE_ALIGNMENT	64		//byte alignment of every stream
+#define PARTICLESTORE_PADDING	16		//streams are padded to a multiple of this many floats
+
+//Structure of arrays particle container, one aligned float stream per component
+struct ParticleStore {
+	float *px;
+	float *py;
+	float *pz;
+	float *vx;
+	float *vy;
+	float *vz;
+
+	//Constructors
+	ParticleStore() {
+		_init(0);
+	}
+	ParticleStore(int count) {
+		_init(count);
+	}
+	ParticleStore(const ParticleStore &other) {
+		_init(other._count);
+		if (_memory != NULL) {
+			memcpy(px, other.px, sizeof(float) * _stride * 6);
+		}
+	}
+	ParticleStore(ParticleStore &&other) {
+		_init(0);
+		_swap(other);
+	}
+
+	//Destructor
+	~ParticleStore() {
+		delete[] _memory;
+	}
+
+	ParticleStore& operator =(const ParticleStore &other) {
+		if (&other == this) {
+			return *this;
+		}
+		delete[] _memory;
+		_init(other._count);
+		if (_memory != NULL) {
+			memcpy(px, other.px, sizeof(float) * _stride * 6);
+		}
+		return *this;
+	}
+	ParticleStore& operator =(ParticleStore &&other) {
+		_swap(other);
+		return *this;
+	}
+
+	//Method designed to return the number of particles
+	int size() const {
+		return _count;
+	}
+
+	//Method designed to return the six padded streams as one contiguous block of streamBytes() bytes
+	//Stores of the same size share the layout, so a store can be saved and restored with a single memcpy
+	float* streams() {
+		return px;
+	}
+	const float* streams() const {
+		return px;
+	}
+	size_t streamBytes() const {
+		return sizeof(float) * _stride * 6;
+	}
+
+	//Methods designed to read and write a single particle
+	xlib::vec3 position(int i) const {
+		return xlib::vec3(px[i], py[i], pz[i]);
+	}
+	xlib::vec3 velocity(int i) const {
+		return xlib::vec3(vx[i], vy[i], vz[i]);
+	}
+	void setPosition(int i, const xlib::vec3 &position) {
+		px[i] = position.x;
+		py[i] = position.y;
+		pz[i] = position.z;
+	}
+	void setVelocity(int i, const xlib::vec3 &velocity) {
+		vx[i] = velocity.x;
+		vy[i] = velocity.y;
+		vz[i] = velocity.z;
+	}
+	Particle operator [](int i) const {
+		Particle particle;
+		particle.position = position(i);
+		particle.velocity = velocity(i);
+		return particle;
+	}
+
+private:
+	float *_memory;		//single allocation holding all six streams
+	int _count;
+	int _stride;		//padded length of a stream in floats
+
+	//Method designed to exchange the streams of two stores
+	void _swap(ParticleStore &other) {
+		std::swap(px, other.px);
+		std::swap(py, other.py);
+		std::swap(pz, other.pz);
+		std::swap(vx, other.vx);
+		std::swap(vy, other.vy);
+		std::swap(vz, other.vz);
+		std::swap(_memory, other._memory);
+		std::swap(_count, other._count);
+		std::swap(_stride, other._stride);
+	}
+
+	//Method designed to allocate zeroed streams for count particles
+	void _init(int count) {
+		_count = count;
+		_stride = (count + PARTICLESTORE_PADDING - 1) / PARTICLESTORE_PADDING * PARTICLESTORE_PADDING;
+		_memory = NULL;
+		px = py = pz = vx = vy = vz = NULL;
+		if (count <= 0) {
+			return;
+		}
+
+		int extra = PARTICLESTORE_ALIGNMENT / sizeof(float);
+		_memory = new float[_stride * 6 + extra];
+		float *base = _memory;
+		while (((uintptr_t)base) % PARTICLESTORE_ALIGNMENT != 0) {
+			base++;
+		}
+		memset(base, 0, sizeof(float) * _stride * 6);
+		px = base;
+		py = base + _stride;
+		pz = base + _stride * 2;
+		vx = base + _stride * 3;
+		vy = base + _stride * 4;
+		vz = base + _stride * 5;
+	}
+};
+
+#endif
@@ -0,0 +1,308 @@
+/**
+* simulationbatch.h
+* @fileoverview .h file designed to run many simulations of one scenario with different settings
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef SIMULATIONBATCH_H
+#define SIMULATIONBATCH_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include "massmovementsimulator.h"
+#include "simulationfactory.h"
+
+//Settings of one run of a batch, applied on top of the settings file of the batch
+struct BatchRun {
+	vector<string> params;		//setting names as used in settings files
+	vector<string> values;		//value of each setting
+};
+
+//Summary metrics of a finished run
+struct BatchResult {
+	int    steps;				//steps taken
+	int    resumedStep;			//step the run continued from a checkpoint file, 0 if it started fresh
+	double seconds;				//wall time of the steps after resumedStep
+	int    particles;			//number of particles
+	int    active;				//particles still moving over the terrain at the end
+	int    sleeping;			//particles asleep at the end
+	int    coveredPixels;		//forceMap pixels any particle moved through
+	double forceMapSum;			//sum of every forceMap pixel
+	double maxForce;			//largest forceMap pixel
+	double pathError;			//MassMovementSimulator::pathError() of the forceMap, -1 without path images
+};
+
+//Method designed to read a batch file into a list of runs, returns false if the file cannot be used
+//
+//Every line names a setting followed by the values it takes, for example
+//	mode			grid
+//	viscosity		0.1 0.25 0.5
+//	seed			1 2 3 4
+//In grid mode (the default) every combination of the values is run, in list mode the n-th values of every setting form run n
+//and every setting has to list the same number of values
+bool parseBatch(const string &batchFile, vector<BatchRun> &runs) {
+	ifstream fin(batchFile.c_str());
+	if (fin.fail()) {
+		cout << "ERROR: Failed to open file: " << batchFile << endl;
+		return false;
+	}
+	cout << "Loading batch file: " << batchFile << endl;
+
+	bool grid = true;
+	vector<string> params;
+	vector<vector<string> > values;
+	MassMovementSimulator probe;
+	while (!fin.eof()) {
+		string tmpline;
+		stringstream line;
+		getline(fin, tmpline);
+		line << tmpline;
+		string param;
+		line >> param;
+		if (param.empty()) {
+			continue;
+		}
+		if (param[0] == '#') {
+			continue;
+		}
+
+		if (param == "mode") {
+			string mode;
+			line >> mode;
+			if (mode != "grid" && mode != "list") {
+				cout << "ERROR: Unknown batch mode: " << mode << endl;
+				return false;
+			}
+			grid = mode == "grid";
+			continue;
+		}
+
+		vector<string> settingValues;
+		string value;
+		while (line >> value) {
+			stringstream check(value);
+			if (!applySetting(param, check, probe)) {
+				cout << "ERROR: Unknown setting in batch file: " << param << endl;
+				return false;
+			}
+			settingValues.push_back(value);
+		}
+		if (settingValues.empty()) {
+			cout << "ERROR: No values given for setting: " << param << endl;
+			return false;
+		}
+		params.push_back(param);
+		values.push_back(settingValues);
+	}
+
+	runs.clear();
+	if (params.empty()) {
+		runs.push_back(BatchRun());
+		return true;
+	}
+	if (grid) {
+		//count through the combinations with the last setting changing fastest
+		vector<int> digit(params.size(), 0);
+		while (true) {
+			BatchRun run;
+			for (int p = 0; p < (int)params.size(); p++) {
+				run.params.push_back(params[p]);
+				run.values.push_back(values[p][digit[p]]);
+			}
+			runs.push_back(run);
+
+			int p = params.size() - 1;
+			while (p >= 0 && ++digit[p] == (int)values[p].size()) {
+				digit[p] = 0;
+				p--;
+			}
+			if (p < 0) {
+				break;
+			}
+		}
+	}
+	else {
+		for (int p = 1; p < (int)params.size(); p++) {
+			if (values[p].size() != values[0].size()) {
+				cout << "ERROR: Every setting of a list batch needs " << values[0].size() << " values, " << params[p] << " has " << values[p].size() << endl;
+				return false;
+			}
+		}
+		for (int r = 0; r < (int)values[0].size(); r++) {
+			BatchRun run;
+			for (int p = 0; p < (int)params.size(); p++) {
+				run.params.push_back(params[p]);
+				run.values.push_back(values[p][r]);
+			}
+			runs.push_back(run);
+		}
+	}
+	return true;
+}
+
+//Runs of one scenario executed concurrently, one single threaded simulation per job
+//Every run shares the terrain through the TerrainCache and copies the start zone and path images that were decoded once,
+//so starting a run only costs parsing its settings and placing its particles
+struct SimulationBatch {
+
+	string dataFile;						//data file every run reads its terrain and start zone from
+	string settingsText;					//contents of the settings file every run starts from
+	MassMovementSimulator base;				//simulation the file names and start zone of every run are taken from
+	int jobs;								//number of runs executed at the same time
+	int checkpointSteps;					//steps between the checkpoint files of a run (0 writes none)
+	string checkpointPrefix;				//the checkpoint file of run r is checkpointPrefix + "run_r.checkpoint"
+
+	//Constructor
+	SimulationBatch() {
+		jobs = xlib::clamp((int)std::thread::hardware_concurrency(), 1, 64);
+		checkpointSteps = 0;
+	}
+
+	//Method designed to load the shared terrain, start zone and path images, returns false if the settings file cannot be read
+	bool init(const string &dataFile, const string &settingsFile) {
+		this->dataFile = dataFile;
+		ifstream fin(settingsFile.c_str());
+		if (fin.fail()) {
+			cout << "ERROR: Failed to open file: " << settingsFile << endl;
+			return false;
+		}
+		stringstream text;
+		text << fin.rdbuf();
+		settingsText = text.str();
+
+		parseData(dataFile, base);
+		stringstream settings(settingsText);
+		applySettings(settings, base);
+		base.initTerrain();
+		base.initParticles();
+		base.initPath();
+		return true;
+	}
+
+	//Method designed to set up a simulation for the given run
+	//numThreads defaults to 1 because the runs themselves keep every core busy, a run may still override it
+	//Runs keep no in memory checkpoints, they write checkpoint files instead when checkpointSteps is set
+	void initRun(const BatchRun &run, MassMovementSimulator &simulator) {
+		simulator.elevationDEMFile = base.elevationDEMFile;
+		simulator.terrainColorFile = base.terrainColorFile;
+		simulator.startingZoneFile = base.startingZoneFile;
+		simulator.flowPathOutputFile = base.flowPathOutputFile;
+		simulator.pathFile = base.pathFile;
+		simulator.pathDistanceMapFile = base.pathDistanceMapFile;
+
+		stringstream settings(settingsText);
+		applySettings(settings, simulator);
+		simulator.numThreads = 1;
+		simulator.checkpointInterval = 0;
+		for (int p = 0; p < (int)run.params.size(); p++) {
+			stringstream value(run.values[p]);
+			applySetting(run.params[p], value, simulator);
+		}
+
+		simulator.initTerrain();
+		simulator.particleStart = base.particleStart;
+		simulator.placeParticles();
+		simulator.pathImage = base.pathImage;
+		simulator.pathDistanceMap = base.pathDistanceMap;
+	}
+
+	//Method designed to return the checkpoint file of a run
+	string checkpointFile(int run) const {
+		stringstream name;
+		name << checkpointPrefix << "run_" << run << ".checkpoint";
+		return name.str();
+	}
+
+	//Method designed to step a simulation to maxIterations and return its metrics
+	//With a checkpoint file the state is written to it every checkpointSteps steps and once the run is done
+	static BatchResult finishRun(MassMovementSimulator &simulator, const string &checkpointFile = "", int checkpointSteps = 0) {
+		BatchResult result;
+		long long start = SimulationProfile::now();
+		while ((int)simulator.stepCount < simulator.maxIterations) {
+			simulator.updateAllParticles();
+			if (checkpointSteps > 0 && (simulator.stepCount % checkpointSteps == 0 || (int)simulator.stepCount == simulator.maxIterations)) {
+				simulator.writeCheckpoint(checkpointFile);
+			}
+		}
+		result.seconds = (SimulationProfile::now() - start) / 1e9;
+		result.steps = simulator.stepCount;
+		result.resumedStep = 0;
+
+		result.particles = simulator.particles.size();
+		result.sleeping = simulator.sleepingParticles();
+		result.active = simulator.activeParticles();
+
+		simulator.resolveForceMap();
+		const float *force = (const float*)simulator.forceMap.getDataSource();
+		result.coveredPixels = 0;
+		result.forceMapSum = 0;
+		result.maxForce = 0;
+		for (int p = 0; p < simulator.forceMap.width() * simulator.forceMap.height(); p++) {
+			if (force[p] > 0) {
+				result.coveredPixels++;
+			}
+			result.forceMapSum += force[p];
+			result.maxForce = force[p] > result.maxForce ? force[p] : result.maxForce;
+		}
+		result.pathError = simulator.pathError();
+		return result;
+	}
+
+	//Method designed to call job(r) for every r in [0, count) on up to jobs threads and block until all of them finish
+	//Every thread takes the next r as soon as its previous one is done, so runs of different length keep every thread busy
+	void forEach(int count, const std::function<void(int)> &job) {
+		std::atomic<int> next(0);
+		auto loop = [&]() {
+			for (int r = next++; r < count; r = next++) {
+				job(r);
+			}
+		};
+
+		vector<std::thread> threads;
+		int threadCount = xlib::clamp(jobs, 1, count > 0 ? count : 1);
+		for (int t = 1; t < threadCount; t++) {
+			threads.push_back(std::thread(loop));
+		}
+		loop();
+		for (int t = 0; t < (int)threads.size(); t++) {
+			threads[t].join();
+		}
+	}
+
+	//Method designed to execute every run and store the metrics of run r in results[r]
+	//With checkpointSteps set a run continues from its checkpoint file if one exists, so a batch that was interrupted
+	//can be started again and only repeats the steps after the last checkpoint of every run
+	//A checkpoint taken with other settings than the run has now, because the batch file was edited, is ignored
+	//finished(r, simulator) is called after run r completed, one call at a time, while its simulation still exists
+	void run(const vector<BatchRun> &runs, vector<BatchResult> &results, const std::function<void(int, MassMovementSimulator&)> &finished) {
+		results.assign(runs.size(), BatchResult());
+		std::mutex finishedLock;
+		forEach(runs.size(), [&](int r) {
+			MassMovementSimulator simulator;
+			initRun(runs[r], simulator);
+			SimulationCheckpoint checkpoint;
+			int resumedStep = 0;
+			if (checkpointSteps > 0 && checkpoint.load(checkpointFile(r))) {
+				if (simulator.checkpointSettingsMatch(checkpoint) && simulator.restoreCheckpoint(checkpoint)) {
+					resumedStep = simulator.stepCount;
+					cout << "Resuming run " << r << " from step " << resumedStep << endl;
+				}
+				else {
+					cout << "Checkpoint of run " << r << " does not match its settings, starting fresh" << endl;
+				}
+			}
+			results[r] = finishRun(simulator, checkpointFile(r), checkpointSteps);
+			results[r].resumedStep = resumedStep;
+
+			std::lock_guard<std::mutex> guard(finishedLock);
+			finished(r, simulator);
+		});
+	}
+};
+
+#endif
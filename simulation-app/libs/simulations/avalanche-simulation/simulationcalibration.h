@@ -0,0 +1,333 @@
+/**
+* simulationcalibration.h
+* @fileoverview .h file designed to fit the physics settings of a simulation to an observed flow path
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef SIMULATIONCALIBRATION_H
+#define SIMULATIONCALIBRATION_H
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include "massmovementsimulator.h"
+#include "simulationfactory.h"
+#include "simulationbatch.h"
+
+#define CALIBRATION_CHECKPOINTS 4		//number of times the pathError of a candidate run is checked while it is stepped
+
+//Setting fitted by the calibration and the range it is searched in
+struct CalibrationParam {
+	string name;
+	double low;
+	double high;
+};
+
+//Point of the search space together with its score
+struct CalibrationPoint {
+	vector<double> x;							//value of every param as a fraction of its range
+	double error;								//mean pathError over the seeds, infinity if the candidate was abandoned
+	double trajectory[CALIBRATION_CHECKPOINTS];	//mean pathError over the seeds at every checkpoint
+};
+
+//Nelder-Mead search over the settings listed in a calibration file that minimizes MassMovementSimulator::pathError()
+//
+//Each candidate is scored by short runs over several seeds. The reflection, expansion and both contractions of an iteration
+//are run at the same time, so one iteration takes about as long as one run when enough cores are available.
+//Candidates are only kept if they beat the worst point of the simplex, so a run is abandoned at a checkpoint once its pathError
+//is worse than the worst point's at the same checkpoint by more than abandonTolerance and hopeless candidates only cost a
+//fraction of a run. Every point of the simplex finished all its runs, so its trajectory is always complete.
+struct SimulationCalibration {
+
+	SimulationBatch batch;				//terrain, start zone, path images and base settings shared by every run
+	vector<CalibrationParam> params;	//settings that are fitted
+	int    steps;						//steps of every run
+	int    seeds;						//runs per candidate, using seeds 1 to seeds
+	int    iterations;					//maximum number of Nelder-Mead iterations
+	double initialStep;					//size of the initial simplex as a fraction of every range
+	double abandonTolerance;			//pathError margin over the worst point at which a run is abandoned
+	double convergence;					//the search stops once every point of the simplex is within this error of the best
+
+	int    evaluations;					//number of runs started
+	int    abandoned;					//number of runs abandoned before their last step
+
+	//Constructor
+	SimulationCalibration() {
+		steps = 600;
+		seeds = 2;
+		iterations = 40;
+		initialStep = 0.25;
+		abandonTolerance = 0.002;
+		convergence = 0.0001;
+		evaluations = 0;
+		abandoned = 0;
+	}
+
+	//Method designed to read a calibration file, returns false if the file cannot be used
+	//
+	//Every setting to fit is listed with its range, the other lines adjust the search
+	//	viscosity		0.0 1.0
+	//	steps			600
+	//	seeds			2
+	//	iterations		40
+	//	initialStep		0.25
+	//	tolerance		0.002
+	bool parse(const string &calibrationFile) {
+		ifstream fin(calibrationFile.c_str());
+		if (fin.fail()) {
+			cout << "ERROR: Failed to open file: " << calibrationFile << endl;
+			return false;
+		}
+		cout << "Loading calibration file: " << calibrationFile << endl;
+
+		params.clear();
+		MassMovementSimulator probe;
+		while (!fin.eof()) {
+			string tmpline;
+			stringstream line;
+			getline(fin, tmpline);
+			line << tmpline;
+			string param;
+			line >> param;
+			if (param.empty()) {
+				continue;
+			}
+			if (param[0] == '#') {
+				continue;
+			}
+
+			if (param == "steps") {
+				line >> steps;
+			}
+			else if (param == "seeds") {
+				line >> seeds;
+			}
+			else if (param == "iterations") {
+				line >> iterations;
+			}
+			else if (param == "initialStep") {
+				line >> initialStep;
+			}
+			else if (param == "tolerance") {
+				line >> abandonTolerance;
+			}
+			else {
+				CalibrationParam range;
+				range.name = param;
+				stringstream check("0");
+				if (!applySetting(param, check, probe) || !(line >> range.low >> range.high) || range.high <= range.low) {
+					cout << "ERROR: Expected a setting followed by its low and high value: " << tmpline << endl;
+					return false;
+				}
+				params.push_back(range);
+			}
+		}
+		if (params.empty()) {
+			cout << "ERROR: No settings to calibrate in: " << calibrationFile << endl;
+			return false;
+		}
+		steps = std::max(steps, CALIBRATION_CHECKPOINTS);
+		seeds = std::max(seeds, 1);
+		return true;
+	}
+
+	//Method designed to return the value of param p at the point x
+	double value(const vector<double> &x, int p) const {
+		return params[p].low + x[p] * (params[p].high - params[p].low);
+	}
+
+	//Method designed to build the run of the point x with the given seed
+	BatchRun toRun(const vector<double> &x, int seed) const {
+		BatchRun run;
+		for (int p = 0; p < (int)params.size(); p++) {
+			stringstream text;
+			text.precision(9);
+			text << value(x, p);
+			run.params.push_back(params[p].name);
+			run.values.push_back(text.str());
+		}
+		stringstream text;
+		text << seed;
+		run.params.push_back("seed");
+		run.values.push_back(text.str());
+		return run;
+	}
+
+	//Method designed to score every point with seeds runs each, abandoning runs that fall behind reference (NULL never abandons)
+	void evaluate(vector<CalibrationPoint*> &points, const CalibrationPoint *reference) {
+		int count = points.size() * seeds;
+		vector<double> errors(count * CALIBRATION_CHECKPOINTS, 0.0);
+		vector<int> finished(count, 0);
+
+		batch.forEach(count, [&](int job) {
+			MassMovementSimulator simulator;
+			batch.initRun(toRun(points[job / seeds]->x, job % seeds + 1), simulator);
+			int step = 0;
+			for (int k = 0; k < CALIBRATION_CHECKPOINTS; k++) {
+				for (; step < steps * (k + 1) / CALIBRATION_CHECKPOINTS; step++) {
+					simulator.updateAllParticles();
+				}
+				double error = simulator.pathError();
+				errors[job * CALIBRATION_CHECKPOINTS + k] = error;
+				if (reference && k + 1 < CALIBRATION_CHECKPOINTS && error > reference->trajectory[k] + abandonTolerance) {
+					return;
+				}
+			}
+			finished[job] = 1;
+		});
+
+		for (int i = 0; i < (int)points.size(); i++) {
+			CalibrationPoint &point = *points[i];
+			bool complete = true;
+			for (int k = 0; k < CALIBRATION_CHECKPOINTS; k++) {
+				point.trajectory[k] = 0;
+			}
+			for (int s = 0; s < seeds; s++) {
+				int job = i * seeds + s;
+				complete = complete && finished[job];
+				for (int k = 0; k < CALIBRATION_CHECKPOINTS; k++) {
+					point.trajectory[k] += errors[job * CALIBRATION_CHECKPOINTS + k] / seeds;
+				}
+				abandoned += finished[job] ? 0 : 1;
+			}
+			point.error = complete ? point.trajectory[CALIBRATION_CHECKPOINTS - 1] : std::numeric_limits<double>::infinity();
+		}
+		evaluations += count;
+	}
+
+	//Method designed to return the value of the named setting of a simulation, 0 for settings that are not numbers
+	static double baseValue(const MassMovementSimulator &simulator, const string &name) {
+		if (name == "initialHeight") {
+			return simulator.initialHeight;
+		}
+		else if (name == "bounceFriction") {
+			return simulator.bounceFriction;
+		}
+		else if (name == "stickyness") {
+			return simulator.stickyness;
+		}
+		else if (name == "dampingForce") {
+			return simulator.dampingForce;
+		}
+		else if (name == "turbulanceForce") {
+			return simulator.turbulanceForce;
+		}
+		else if (name == "clumpingFactor") {
+			return simulator.clumpingFactor;
+		}
+		else if (name == "viscosity") {
+			return simulator.viscosity;
+		}
+		else if (name == "sleepVelocity") {
+			return simulator.sleepVelocity;
+		}
+		return 0;
+	}
+
+	//Method designed to return the point c + t * (c - w) clamped to the search ranges
+	static CalibrationPoint along(const vector<double> &c, const vector<double> &w, double t) {
+		CalibrationPoint point;
+		for (int p = 0; p < (int)c.size(); p++) {
+			point.x.push_back(std::min(std::max(c[p] + t * (c[p] - w[p]), 0.0), 1.0));
+		}
+		return point;
+	}
+
+	//Method designed to run the search from the base settings and return the best point found
+	//progress(iteration, best) is called after the initial simplex and after every iteration
+	CalibrationPoint run(const std::function<void(int, const CalibrationPoint&)> &progress) {
+		int n = params.size();
+		evaluations = 0;
+		abandoned = 0;
+
+		//initial simplex around the base settings
+		vector<CalibrationPoint> simplex(n + 1);
+		vector<double> start(n);
+		for (int p = 0; p < n; p++) {
+			start[p] = std::min(std::max((baseValue(batch.base, params[p].name) - params[p].low) / (params[p].high - params[p].low), 0.0), 1.0);
+		}
+		for (int i = 0; i <= n; i++) {
+			simplex[i].x = start;
+			if (i > 0) {
+				double &x = simplex[i].x[i - 1];
+				x = x + initialStep <= 1.0 ? x + initialStep : x - initialStep;
+			}
+		}
+		vector<CalibrationPoint*> points;
+		for (int i = 0; i <= n; i++) {
+			points.push_back(&simplex[i]);
+		}
+		evaluate(points, NULL);
+
+		for (int iteration = 0; ; iteration++) {
+			std::sort(simplex.begin(), simplex.end(), [](const CalibrationPoint &a, const CalibrationPoint &b) {
+				return a.error < b.error;
+			});
+			progress(iteration, simplex[0]);
+			if (iteration == iterations || simplex[n].error - simplex[0].error < convergence) {
+				break;
+			}
+
+			vector<double> centroid(n, 0.0);
+			for (int i = 0; i < n; i++) {
+				for (int p = 0; p < n; p++) {
+					centroid[p] += simplex[i].x[p] / n;
+				}
+			}
+			const vector<double> &worst = simplex[n].x;
+			CalibrationPoint reflected = along(centroid, worst, 1.0);
+			CalibrationPoint expanded = along(centroid, worst, 2.0);
+			CalibrationPoint outside = along(centroid, worst, 0.5);
+			CalibrationPoint inside = along(centroid, worst, -0.5);
+			points.clear();
+			points.push_back(&reflected);
+			points.push_back(&expanded);
+			points.push_back(&outside);
+			points.push_back(&inside);
+			evaluate(points, &simplex[n]);
+
+			if (reflected.error < simplex[0].error) {
+				simplex[n] = expanded.error < reflected.error ? expanded : reflected;
+			}
+			else if (reflected.error < simplex[n - 1].error) {
+				simplex[n] = reflected;
+			}
+			else if (reflected.error < simplex[n].error && outside.error <= reflected.error) {
+				simplex[n] = outside;
+			}
+			else if (reflected.error >= simplex[n].error && inside.error < simplex[n].error) {
+				simplex[n] = inside;
+			}
+			else {
+				//shrink every point towards the best one
+				points.clear();
+				for (int i = 1; i <= n; i++) {
+					simplex[i] = along(simplex[0].x, simplex[i].x, -0.5);
+					points.push_back(&simplex[i]);
+				}
+				evaluate(points, NULL);
+			}
+		}
+		return simplex[0];
+	}
+
+	//Method designed to write the base settings followed by the fitted values of the point as a settings file
+	bool writeSettings(const string &fileName, const CalibrationPoint &point) const {
+		ofstream fout(fileName.c_str());
+		if (fout.fail()) {
+			cout << "ERROR: Failed to open file: " << fileName << endl;
+			return false;
+		}
+		fout << batch.settingsText << endl;
+		fout << "#calibrated settings, pathError " << point.error << endl;
+		fout.precision(9);
+		for (int p = 0; p < (int)params.size(); p++) {
+			fout << params[p].name << "\t" << value(point.x, p) << endl;
+		}
+		return true;
+	}
+};
+
+#endif
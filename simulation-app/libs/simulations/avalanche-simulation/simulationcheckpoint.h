@@ -0,0 +1,147 @@
+/**
+* simulationcheckpoint.h
+* @fileoverview .h file designed to hold binary snapshots of the state of a simulation
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef SIMULATIONCHECKPOINT_H
+#define SIMULATIONCHECKPOINT_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+#define CHECKPOINT_MAGIC	0x4353534D	//"MSSC" in the first four bytes of every checkpoint
+#define CHECKPOINT_VERSION	3
+#define CHECKPOINT_SETTINGS		9		//float settings stored in a checkpoint, see MassMovementSimulator::motionSettings()
+#define CHECKPOINT_INT_SETTINGS	3		//int settings stored in a checkpoint
+
+//Binary snapshot of a simulation taken after the given step, see MassMovementSimulator::saveCheckpoint() for the layout
+//The data holds plain copies of the particle streams and per particle state, so saving and restoring are a few memcpys
+struct SimulationCheckpoint {
+
+	unsigned int step;					//stepCount of the simulation when the checkpoint was taken
+	std::vector<unsigned char> data;	//the snapshot itself, also the contents of a checkpoint file
+
+	//Constructor
+	SimulationCheckpoint() {
+		step = 0;
+	}
+
+	//Method designed to start a new snapshot, keeping the allocation of the previous one
+	void clear(unsigned int step) {
+		this->step = step;
+		data.clear();
+	}
+
+	//Method designed to append bytes to the snapshot
+	void write(const void *source, size_t bytes) {
+		size_t offset = data.size();
+		data.resize(offset + bytes);
+		if (bytes > 0) {
+			memcpy(&data[offset], source, bytes);
+		}
+	}
+
+	//Method designed to read bytes at offset from the snapshot and advance offset, returns false past the end
+	bool read(size_t &offset, void *target, size_t bytes) const {
+		if (offset + bytes > data.size()) {
+			return false;
+		}
+		if (bytes > 0) {
+			memcpy(target, &data[offset], bytes);
+		}
+		offset += bytes;
+		return true;
+	}
+
+	//Method designed to write the snapshot to a file, returns false if the file cannot be written
+	//The file is written next to its final name and renamed afterwards, so a crash never leaves a partial checkpoint behind
+	bool save(const std::string &fileName) const {
+		std::string partial = fileName + ".partial";
+		std::ofstream fout(partial.c_str(), std::ios::binary);
+		if (fout.fail()) {
+			return false;
+		}
+		fout.write((const char*)data.data(), data.size());
+		fout.close();
+		if (fout.fail()) {
+			return false;
+		}
+		return std::rename(partial.c_str(), fileName.c_str()) == 0;
+	}
+
+	//Method designed to read a snapshot written by save(), returns false if the file cannot be read
+	bool load(const std::string &fileName) {
+		std::ifstream fin(fileName.c_str(), std::ios::binary);
+		if (fin.fail()) {
+			return false;
+		}
+		fin.seekg(0, std::ios::end);
+		data.resize((size_t)fin.tellg());
+		fin.seekg(0, std::ios::beg);
+		fin.read((char*)data.data(), data.size());
+		return !fin.fail();
+	}
+};
+
+//Checkpoints of the most recent steps of a simulation, oldest first
+//Storing a checkpoint drops every checkpoint of the same or a later step, so after a restore the ring
+//follows the new history of the simulation instead of mixing in steps that were taken before it
+struct CheckpointRing {
+
+	std::vector<SimulationCheckpoint> checkpoints;	//stored checkpoints ordered by step
+	std::vector<SimulationCheckpoint> spare;		//buffers of dropped checkpoints that are reused by the next ones
+
+	//Method designed to return the number of stored checkpoints
+	int size() const {
+		return checkpoints.size();
+	}
+
+	//Method designed to drop every checkpoint
+	void clear() {
+		while (!checkpoints.empty()) {
+			drop(checkpoints.size() - 1);
+		}
+	}
+
+	//Method designed to make room for the checkpoint of a step and return it, capacity is the number of checkpoints kept
+	SimulationCheckpoint& next(unsigned int step, int capacity) {
+		while (!checkpoints.empty() && checkpoints.back().step >= step) {
+			drop(checkpoints.size() - 1);
+		}
+		while (!checkpoints.empty() && (int)checkpoints.size() >= capacity) {
+			drop(0);
+		}
+		SimulationCheckpoint checkpoint;
+		if (!spare.empty()) {
+			std::swap(checkpoint, spare.back());
+			spare.pop_back();
+		}
+		checkpoint.clear(step);
+		checkpoints.push_back(std::move(checkpoint));
+		return checkpoints.back();
+	}
+
+	//Method designed to return the checkpoint of the given step, NULL if it is not stored
+	const SimulationCheckpoint* find(unsigned int step) const {
+		for (int i = 0; i < (int)checkpoints.size(); i++) {
+			if (checkpoints[i].step == step) {
+				return &checkpoints[i];
+			}
+		}
+		return NULL;
+	}
+
+private:
+	//Method designed to move checkpoint i to the spare buffers
+	void drop(int i) {
+		spare.push_back(std::move(checkpoints[i]));
+		checkpoints.erase(checkpoints.begin() + i);
+	}
+};
+
+#endif
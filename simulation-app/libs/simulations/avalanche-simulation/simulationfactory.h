@@ -10,19 +10,87 @@
 
 #include "massmovementsimulator.h"
 
-//Method designed to assign variables of a simulation from a file
-void parseSettings(const string &settingsFile, MassMovementSimulator &simulator) {
-	ifstream fin(settingsFile.c_str());
-	if (fin.fail()) {
-		cout << "ERROR: Failed to open file: " << settingsFile << endl;
-		return;
+//Method designed to assign one setting of a simulation from the rest of its line, returns false if the setting is unknown
+bool applySetting(const string &param, istream &line, MassMovementSimulator &simulator) {
+	//TODO refactor if statement, potentially use map to fix this
+	if (param == "initialHeight") {
+		line >> simulator.initialHeight;
 	}
-	cout << "Loading settings file: " << settingsFile << endl;
+	else if (param == "bounceFriction") {
+		line >> simulator.bounceFriction;
+	}
+	else if (param == "stickyness") {
+		line >> simulator.stickyness;
+	}
+	else if (param == "dampingForce") {
+		line >> simulator.dampingForce;
+	}
+	else if (param == "turbulanceForce") {
+		line >> simulator.turbulanceForce;
+	}
+	else if (param == "clumpingFactor") {
+		line >> simulator.clumpingFactor;
+	}
+	else if (param == "viscosity") {
+		line >> simulator.viscosity;
+	}
+	else if (param == "gridSize") {
+		line >> simulator.gridSize;
+	}
+	else if (param == "maxIterations") {
+		line >> simulator.maxIterations;
+	}
+	else if (param == "verboseOutput") {
+		line >> simulator.verboseOutput;
+	}
+	else if (param == "framesPerSecond") {
+		line >> simulator.framesPerSecond;
+	}
+	else if (param == "numThreads") {
+		line >> simulator.numThreads;
+	}
+	else if (param == "useSimd") {
+		line >> simulator.useSimd;
+	}
+	else if (param == "sleepVelocity") {
+		line >> simulator.sleepVelocity;
+	}
+	else if (param == "sleepSteps") {
+		line >> simulator.sleepSteps;
+	}
+	else if (param == "seed") {
+		line >> simulator.seed;
+	}
+	else if (param == "checkpointInterval") {
+		line >> simulator.checkpointInterval;
+	}
+	else if (param == "checkpointCount") {
+		line >> simulator.checkpointCount;
+	}
+	else if (param == "frameBudget") {
+		line >> simulator.frameBudget;
+	}
+	else if (param == "meshTolerance") {
+		line >> simulator.meshTolerance;
+	}
+	else if (param == "timeStep") {
+		line >> simulator.timeStep;
+	}
+	else if (param == "smoothTerrain") {
+		line >> simulator.smoothTerrain;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
 
-	while (!fin.eof()) {
+//Method designed to assign variables of a simulation from a stream holding the lines of a settings file
+void applySettings(istream &in, MassMovementSimulator &simulator) {
+	while (!in.eof()) {
 		string tmpline;
 		stringstream line;
-		getline(fin, tmpline);
+		getline(in, tmpline);
 		line << tmpline;
 		string param;
 		line >> param;
@@ -32,42 +100,19 @@ void parseSettings(const string &settingsFile, MassMovementSimulator &simulator)
 		if (param[0] == '#') {
 			continue;
 		}
+		applySetting(param, line, simulator);
+	}
+}
 
-		//TODO refactor if statement, potentially use map to fix this
-		if (param == "initialHeight") {
-			line >> simulator.initialHeight;
-		}
-		else if (param == "bounceFriction") {
-			line >> simulator.bounceFriction;
-		}
-		else if (param == "stickyness") {
-			line >> simulator.stickyness;
-		}
-		else if (param == "dampingForce") {
-			line >> simulator.dampingForce;
-		}
-		else if (param == "turbulanceForce") {
-			line >> simulator.turbulanceForce;
-		}
-		else if (param == "clumpingFactor") {
-			line >> simulator.clumpingFactor;
-		}
-		else if (param == "viscosity") {
-			line >> simulator.viscosity;
-		}
-		else if (param == "gridSize") {
-			line >> simulator.gridSize;
-		}
-		else if (param == "maxIterations") {
-			line >> simulator.maxIterations;
-		}
-		else if (param == "verboseOutput") {
-			line >> simulator.verboseOutput;
-		}
-		else if (param == "framesPerSecond") {
-			line >> simulator.framesPerSecond;
-		}
+//Method designed to assign variables of a simulation from a file
+void parseSettings(const string &settingsFile, MassMovementSimulator &simulator) {
+	ifstream fin(settingsFile.c_str());
+	if (fin.fail()) {
+		cout << "ERROR: Failed to open file: " << settingsFile << endl;
+		return;
 	}
+	cout << "Loading settings file: " << settingsFile << endl;
+	applySettings(fin, simulator);
 }
 
 // method designed to parse the data files to use in the simulation
@@ -110,21 +155,34 @@ void parseData(const string &settingsFile, MassMovementSimulator &simulator) {
 		else if (param == "pathFile") {
 			line >> simulator.pathFile;
 		}
-		else if (param == "pathDistanceMap") {
+		else if (param == "pathDistanceMap" || param == "pathDistanceFile") {
 			line >> simulator.pathDistanceMapFile;
 		}
 	}
 }
 
-//Method designed to return an initialized simulation
-MassMovementSimulator buildSimulator(string datafile = "", string settingsfile = "") {
-	MassMovementSimulator simulator;
+//Method designed to initialize a simulation in place from the given files
+void initSimulator(MassMovementSimulator &simulator, string datafile = "", string settingsfile = "") {
 	if (datafile != "" && settingsfile != "") {
 		parseData(datafile, simulator);
 		parseSettings(settingsfile, simulator);
 	}
 	simulator.initTerrain();
 	simulator.initParticles();
+	simulator.initPath();
+}
+
+//Method designed to return an initialized simulation
+MassMovementSimulator buildSimulator(string datafile = "", string settingsfile = "") {
+	MassMovementSimulator simulator;
+	initSimulator(simulator, datafile, settingsfile);
+	return simulator;
+}
+
+//Method designed to return an initialized simulation that is constructed directly inside its shared_ptr and never copied
+std::shared_ptr<MassMovementSimulator> buildSharedSimulator(string datafile = "", string settingsfile = "") {
+	std::shared_ptr<MassMovementSimulator> simulator = std::make_shared<MassMovementSimulator>();
+	initSimulator(*simulator, datafile, settingsfile);
 	return simulator;
 }
 
@@ -0,0 +1,41 @@
+/**
+* simulationlock.h
+* @fileoverview .h file designed to provide a lock that guards a single simulation
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef SIMULATIONLOCK_H
+#define SIMULATIONLOCK_H
+
+#include <mutex>
+
+//Mutex that can be copied along with the simulation owning it, every copy gets its own unlocked mutex
+//Satisfies Lockable so it can be used with std::lock_guard and std::unique_lock
+struct SimulationLock {
+	std::mutex mutex;
+
+	//Constructors
+	SimulationLock() {
+	}
+	SimulationLock(const SimulationLock &other) {
+	}
+
+	SimulationLock& operator =(const SimulationLock &other) {
+		return *this;
+	}
+
+	void lock() {
+		mutex.lock();
+	}
+
+	bool try_lock() {
+		return mutex.try_lock();
+	}
+
+	void unlock() {
+		mutex.unlock();
+	}
+};
+
+#endif
@@ -0,0 +1,87 @@
+/**
+* simulationprofile.h
+* @fileoverview .h file designed to time the phases of a simulation step
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef SIMULATIONPROFILE_H
+#define SIMULATIONPROFILE_H
+
+#include <chrono>
+#include <cstring>
+
+#define PROFILE_MAX_WORKERS 64
+
+//Phases of a simulation step that are timed separately
+enum SimulationPhase {
+	PROFILE_TRACE,			//terrain collision of every active particle
+	PROFILE_KERNELS,		//gravity and integration kernels
+	PROFILE_REGISTER,		//grid registration and the rebuild of the particle grid
+	PROFILE_UPDATEGRID,		//cell velocity averaging and the viscosity pass
+	PROFILE_FORCEMAP,		//forceMap accumulation into the worker buffers
+	PROFILE_PHASE_COUNT
+};
+
+//Accumulated time spent in each phase, kept per worker so workers never write to the same cache line
+//Times are summed over workers, so with more than one thread they measure cpu time rather than wall time
+struct SimulationProfile {
+
+	//Time of every phase for one worker, padded to a cache line
+	struct WorkerTimes {
+		long long ns[PROFILE_PHASE_COUNT];
+		char padding[64 - (PROFILE_PHASE_COUNT * sizeof(long long)) % 64];
+	};
+
+	bool enabled;				//phases are only timed while this is set
+	long long steps;			//number of steps timed
+	long long particleSteps;	//sum of the particle count of every timed step
+	WorkerTimes workers[PROFILE_MAX_WORKERS];
+
+	//Constructor
+	SimulationProfile() {
+		enabled = false;
+		reset();
+	}
+
+	//Method designed to clear every counter
+	void reset() {
+		steps = 0;
+		particleSteps = 0;
+		memset(workers, 0, sizeof(workers));
+	}
+
+	//Method designed to return a monotonic timestamp in nanoseconds
+	static long long now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	//Method designed to add the time since start to a phase of a worker and return the current timestamp
+	long long add(int worker, SimulationPhase phase, long long start) {
+		long long end = now();
+		workers[worker].ns[phase] += end - start;
+		return end;
+	}
+
+	//Method designed to return the total time of a phase over every worker
+	long long total(SimulationPhase phase) const {
+		long long sum = 0;
+		for (int w = 0; w < PROFILE_MAX_WORKERS; w++) {
+			sum += workers[w].ns[phase];
+		}
+		return sum;
+	}
+
+	//Method designed to return the average time of a phase per particle per step
+	double nsPerParticleStep(SimulationPhase phase) const {
+		return particleSteps > 0 ? double(total(phase)) / double(particleSteps) : 0.0;
+	}
+
+	//Method designed to return the name of a phase
+	static const char* name(SimulationPhase phase) {
+		static const char *names[PROFILE_PHASE_COUNT] = { "trace", "kernels", "register", "updateGrid", "forceMap" };
+		return names[phase];
+	}
+};
+
+#endif
@@ -0,0 +1,221 @@
+/**
+* simulationscheduler.h
+* @fileoverview .h file designed to step a simulation at its own frame rate, independent of the clients showing it
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef SIMULATIONSCHEDULER_H
+#define SIMULATIONSCHEDULER_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include "massmovementsimulator.h"
+
+#define SCHEDULER_PAUSED_PERIOD	0.1	//seconds between frames rebuilt while framesPerSecond is 0 or less, or maxIterations is reached
+
+//Display frame of a simulation after a given step
+struct PublishedFrame {
+	unsigned int step;						//stepCount of the simulation the frame was built from
+	int vertexCount;						//number of vertices
+	std::vector<float> vertices;			//x,y,z of every vertex
+	std::vector<unsigned char> colors;		//r,g,b of every vertex
+	xlib::vec3 low;							//bounding box of every vertex the simulation can produce, see MassMovementSimulator::frameBounds()
+	xlib::vec3 high;
+
+	//Constructor
+	PublishedFrame() {
+		step = 0;
+		vertexCount = 0;
+	}
+};
+
+//Two frames of which readers only ever see the front one while the writer fills the back one
+//The lock is only held to swap the frames or to copy the front one out, never while a frame is being built
+//Every read asks the writer for a new frame, so frames are only built while someone reads them
+struct FrameDoubleBuffer {
+
+	//Constructor
+	FrameDoubleBuffer() {
+		front = 0;
+		sequence = 0;
+		requested = false;
+	}
+
+	//Method designed to return the frame to build the next frame in, only one thread may write frames
+	PublishedFrame& back() {
+		return frames[1 - front];
+	}
+
+	//Method designed to make the back frame the one readers see
+	void publish() {
+		std::lock_guard<std::mutex> guard(lock);
+		front = 1 - front;
+		sequence++;
+	}
+
+	//Method designed to copy the newest frame into target, returns the number of frames published so far (0 if none)
+	unsigned int read(PublishedFrame &target) {
+		std::lock_guard<std::mutex> guard(lock);
+		if (sequence > 0) {
+			target = frames[front];
+		}
+		requested = true;
+		return sequence;
+	}
+
+	//Method designed to return whether a frame should be built, true if nothing was published yet or a reader read the
+	//front frame since the last call
+	bool takeRequest() {
+		std::lock_guard<std::mutex> guard(lock);
+		bool wanted = requested || sequence == 0;
+		requested = false;
+		return wanted;
+	}
+
+private:
+	PublishedFrame frames[2];
+	int front;							//index of the frame readers see
+	unsigned int sequence;				//number of frames published
+	bool requested;						//a reader read the front frame since the writer last checked
+	std::mutex lock;
+};
+
+//Thread that steps a simulation framesPerSecond times a second until maxIterations and publishes its frames
+//
+//Each step holds the stepLock of the simulation, so settings can still be changed in between steps.
+//When a step takes longer than 1 / framesPerSecond the simulation runs as fast as it can instead of trying to
+//catch up afterwards. Readers of the frames never wait for a step, a reader slower than the simulation simply
+//skips the frames published in between its reads. A frame is only built after a step if it was read since the last
+//one was published, so simulations nobody watches cost their steps only, and the last frame stays published once
+//the simulation is paused or done.
+struct SimulationScheduler {
+
+	typedef std::chrono::steady_clock Clock;
+	typedef std::function<void(MassMovementSimulator&, PublishedFrame&)> FrameBuilder;
+
+	FrameDoubleBuffer frames;			//frame of the most recent step
+	FrameEncoder encoder;				//keyframe/delta state of the encoded frames read from frames
+	std::mutex encoderLock;				//held while encoder encodes or acknowledges a frame
+
+	//Constructor, build fills a frame from the simulation while its stepLock is held
+	SimulationScheduler(std::shared_ptr<MassMovementSimulator> simulator, const FrameBuilder &build)
+		: simulator(simulator), build(build) {
+		running = false;
+		woken = false;
+		steps = 0;
+	}
+
+	//Destructor
+	~SimulationScheduler() {
+		stop();
+	}
+
+	//Method designed to start stepping the simulation, does nothing if it is already running
+	void start() {
+		std::lock_guard<std::mutex> guard(wakeLock);
+		if (running) {
+			return;
+		}
+		running = true;
+		thread = std::thread(&SimulationScheduler::loop, this);
+	}
+
+	//Method designed to stop stepping the simulation, blocks until the step in progress finished
+	void stop() {
+		{
+			std::lock_guard<std::mutex> guard(wakeLock);
+			running = false;
+		}
+		wakeSignal.notify_all();
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+
+	//Method designed to make the scheduler pick up a changed framesPerSecond right away instead of after the current frame
+	//Must not be called while holding the stepLock of the simulation
+	void wake() {
+		{
+			std::lock_guard<std::mutex> guard(wakeLock);
+			woken = true;
+		}
+		wakeSignal.notify_all();
+	}
+
+	//Method designed to return the number of steps taken by the scheduler
+	unsigned int stepsTaken() {
+		std::lock_guard<std::mutex> guard(wakeLock);
+		return steps;
+	}
+
+private:
+	std::shared_ptr<MassMovementSimulator> simulator;
+	FrameBuilder build;
+	std::thread thread;
+	std::mutex wakeLock;				//guards running, woken and steps
+	std::condition_variable wakeSignal;
+	bool running;
+	bool woken;
+	unsigned int steps;
+
+	//Method designed to step the simulation, unless it is paused or reached maxIterations, and publish its frame if one was
+	//requested, returns whether a step was taken and sets seconds to the time until the next one
+	bool step(double &seconds) {
+		bool stepped = false;
+		seconds = SCHEDULER_PAUSED_PERIOD;
+		bool wanted = frames.takeRequest();
+		{
+			std::lock_guard<SimulationLock> guard(simulator->stepLock);
+			if (simulator->framesPerSecond > 0 && (int)simulator->stepCount < simulator->maxIterations) {
+				simulator->updateAllParticles();
+				stepped = true;
+				seconds = 1.0 / simulator->framesPerSecond;
+			}
+			if (wanted) {
+				PublishedFrame &frame = frames.back();
+				build(*simulator, frame);
+				frame.step = simulator->stepCount;
+				simulator->frameBounds(frame.low, frame.high);
+			}
+		}
+		if (wanted) {
+			frames.publish();
+		}
+		return stepped;
+	}
+
+	//Method run by the scheduler thread
+	void loop() {
+		Clock::time_point next = Clock::now();
+		while (true) {
+			double seconds;
+			bool stepped = step(seconds);
+
+			std::unique_lock<std::mutex> guard(wakeLock);
+			steps += stepped ? 1 : 0;
+			Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+			Clock::time_point now = Clock::now();
+			next += period;
+			if (next < now) {
+				//the step took longer than a frame, start counting frames again from now
+				next = now;
+			}
+			wakeSignal.wait_until(guard, next, [this]() { return !running || woken; });
+			if (!running) {
+				return;
+			}
+			if (woken) {
+				woken = false;
+				next = Clock::now();
+			}
+		}
+	}
+};
+
+#endif
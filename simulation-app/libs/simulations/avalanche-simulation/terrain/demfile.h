@@ -0,0 +1,399 @@
+/**
+* demfile.h
+* @fileoverview .h file designed to read ESRI ASCII grid DEM files and their binary .demcache sidecars
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef DEMFILE_H
+#define DEMFILE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cfloat>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <functional>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "xlib.h"
+
+#define DEMCACHE_VERSION	1
+#define DEMCACHE_BYTEORDER	0x01020304		//written in native byte order, a cache from another platform will not match
+
+//Method designed to return the size and modification time of a file, returns false if it does not exist
+bool fileStamp(const std::string &path, long long &size, long long &time) {
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0) {
+		return false;
+	}
+	size = (long long)info.st_size;
+	time = (long long)info.st_mtime;
+	return true;
+}
+
+//Read only view of a whole file, memory mapped where the platform supports it
+struct MappedFile {
+	const char *data;
+	size_t size;
+
+	//Constructor
+	MappedFile() {
+		data = NULL;
+		size = 0;
+		_buffer = NULL;
+	}
+
+	//Destructor
+	~MappedFile() {
+		close();
+	}
+
+	//Method designed to map the given file, returns false if it cannot be opened
+	bool open(const std::string &path) {
+		close();
+#ifndef _WIN32
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+		struct stat info;
+		if (fstat(fd, &info) != 0) {
+			::close(fd);
+			return false;
+		}
+		size = (size_t)info.st_size;
+		if (size > 0) {
+			void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapping == MAP_FAILED) {
+				::close(fd);
+				size = 0;
+				return false;
+			}
+			madvise(mapping, size, MADV_SEQUENTIAL);
+			data = (const char*)mapping;
+		}
+		::close(fd);
+		return true;
+#else
+		FILE *file = fopen(path.c_str(), "rb");
+		if (file == NULL) {
+			return false;
+		}
+		fseek(file, 0, SEEK_END);
+		size = (size_t)ftell(file);
+		fseek(file, 0, SEEK_SET);
+		_buffer = new char[size + 1];
+		size = fread(_buffer, 1, size, file);
+		fclose(file);
+		data = _buffer;
+		return true;
+#endif
+	}
+
+	//Method designed to unmap the file
+	void close() {
+#ifndef _WIN32
+		if (data != NULL) {
+			munmap((void*)data, size);
+		}
+#endif
+		delete[] _buffer;
+		_buffer = NULL;
+		data = NULL;
+		size = 0;
+	}
+
+private:
+	char *_buffer;		//file contents when the file is read instead of mapped
+
+	MappedFile(const MappedFile &other);
+	MappedFile& operator =(const MappedFile &other);
+};
+
+//Method designed to parse a decimal number from [p, end), skipping leading whitespace
+//Returns the position after the number, or NULL if there is no number
+//The result is the correctly rounded float, the same value ifstream >> float produces
+const char* parseDEMValue(const char *p, const char *end, float &value) {
+	static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	while (p < end && isspace((unsigned char)*p)) {
+		p++;
+	}
+	const char *start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+
+	unsigned long long mantissa = 0;
+	int digits = 0;				//significant digits held in mantissa
+	int exponent = 0;
+	bool anyDigits = false;
+	bool truncated = false;		//digits were dropped, only strtof can round correctly
+	while (p < end && *p >= '0' && *p <= '9') {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			digits += mantissa != 0;
+		}
+		else {
+			exponent++;
+			truncated |= *p != '0';
+		}
+		anyDigits = true;
+		p++;
+	}
+	if (p < end && *p == '.') {
+		p++;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += mantissa != 0;
+				exponent--;
+			}
+			else {
+				truncated |= *p != '0';
+			}
+			anyDigits = true;
+			p++;
+		}
+	}
+	if (!anyDigits) {
+		return NULL;
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char *e = p + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '-' || *e == '+')) {
+			negativeExponent = *e == '-';
+			e++;
+		}
+		if (e < end && *e >= '0' && *e <= '9') {
+			int power = 0;
+			while (e < end && *e >= '0' && *e <= '9') {
+				if (power < 100000) {
+					power = power * 10 + (*e - '0');
+				}
+				e++;
+			}
+			exponent += negativeExponent ? -power : power;
+			p = e;
+		}
+	}
+
+	//an exact mantissa and power of ten give a correctly rounded double in one operation
+	//rounding that double to float is only ambiguous when it lands exactly halfway between two floats
+	if (!truncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+		double result = (double)mantissa;
+		result = exponent < 0 ? result / powersOf10[-exponent] : result * powersOf10[exponent];
+		unsigned long long bits;
+		memcpy(&bits, &result, sizeof(bits));
+		if ((bits & 0x1FFFFFFFull) != 0x10000000ull && (result == 0 || (result >= FLT_MIN && result <= FLT_MAX))) {
+			value = negative ? -(float)result : (float)result;
+			return p;
+		}
+	}
+
+	char token[128];
+	size_t length = xlib::clamp((int)(p - start), 0, (int)sizeof(token) - 1);
+	memcpy(token, start, length);
+	token[length] = 0;
+	value = strtof(token, NULL);
+	return p;
+}
+
+//Header values of a DEM grid
+struct DEMHeader {
+	int cols;
+	int rows;
+	float xCorner;
+	float yCorner;
+	float cellSize;
+	double nodataValue;
+};
+
+//Binary header at the start of a .demcache file, followed by rows * cols raw float32 heights
+struct DEMCacheHeader {
+	char magic[8];
+	unsigned int version;
+	unsigned int byteOrder;
+	int cols;
+	int rows;
+	double xCorner;
+	double yCorner;
+	double cellSize;
+	double nodataValue;
+	long long sourceSize;		//size and modification time of the ASCII file the cache was built from
+	long long sourceTime;
+};
+
+//Method designed to parse an ESRI ASCII grid into a header and a rows x cols array of raw heights
+bool readDEM_ASCII(const std::string &fileName, DEMHeader &header, xlib::xarray<float> &heights) {
+	MappedFile file;
+	if (!file.open(fileName)) {
+		return false;
+	}
+	const char *p = file.data;
+	const char *end = file.data + file.size;
+
+	//header lines are "key value" pairs, the first line starting with a number begins the heights
+	header.cols = 0;
+	header.rows = 0;
+	header.xCorner = 0;
+	header.yCorner = 0;
+	header.cellSize = 1;
+	header.nodataValue = -9999;
+	for (;;) {
+		while (p < end && isspace((unsigned char)*p)) {
+			p++;
+		}
+		if (p == end || !isalpha((unsigned char)*p)) {
+			break;
+		}
+		const char *keyStart = p;
+		while (p < end && !isspace((unsigned char)*p)) {
+			p++;
+		}
+		std::string key(keyStart, p);
+		for (size_t i = 0; i < key.size(); i++) {
+			key[i] = (char)tolower((unsigned char)key[i]);
+		}
+		while (p < end && (*p == ' ' || *p == '\t')) {
+			p++;
+		}
+		const char *valueStart = p;
+		while (p < end && !isspace((unsigned char)*p)) {
+			p++;
+		}
+		std::stringstream value(std::string(valueStart, p));
+
+		if (key == "ncols") {
+			value >> header.cols;
+		}
+		else if (key == "nrows") {
+			value >> header.rows;
+		}
+		else if (key == "xllcorner" || key == "xllcenter") {
+			value >> header.xCorner;
+		}
+		else if (key == "yllcorner" || key == "yllcenter") {
+			value >> header.yCorner;
+		}
+		else if (key == "cellsize") {
+			value >> header.cellSize;
+		}
+		else if (key == "nodata_value") {
+			value >> header.nodataValue;
+		}
+	}
+	if (header.cols <= 0 || header.rows <= 0) {
+		std::cout << "Error: Missing ncols/nrows in DEM file: " << fileName << std::endl;
+		return false;
+	}
+
+	heights = xlib::xarray<float>(header.rows, header.cols);
+	int count = header.rows * header.cols;
+	for (int i = 0; i < count; i++) {
+		p = parseDEMValue(p, end, heights[i]);
+		if (p == NULL) {
+			std::cout << "Error: DEM file " << fileName << " ends after " << i << " of " << count << " values" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+//Method designed to read a .demcache file, returns false if it is missing or was not built from the given source file
+bool readDEMCache(const std::string &cacheName, long long sourceSize, long long sourceTime, DEMHeader &header, xlib::xarray<float> &heights) {
+	MappedFile file;
+	if (!file.open(cacheName) || file.size < sizeof(DEMCacheHeader)) {
+		return false;
+	}
+	DEMCacheHeader cache;
+	memcpy(&cache, file.data, sizeof(cache));
+	if (memcmp(cache.magic, "DEMCACHE", 8) != 0 || cache.version != DEMCACHE_VERSION || cache.byteOrder != DEMCACHE_BYTEORDER
+		|| cache.sourceSize != sourceSize || cache.sourceTime != sourceTime || cache.cols <= 0 || cache.rows <= 0
+		|| file.size != sizeof(DEMCacheHeader) + sizeof(float) * (size_t)cache.cols * cache.rows) {
+		return false;
+	}
+
+	header.cols = cache.cols;
+	header.rows = cache.rows;
+	header.xCorner = (float)cache.xCorner;
+	header.yCorner = (float)cache.yCorner;
+	header.cellSize = (float)cache.cellSize;
+	header.nodataValue = cache.nodataValue;
+	heights = xlib::xarray<float>(header.rows, header.cols);
+	memcpy(&heights[0], file.data + sizeof(DEMCacheHeader), sizeof(float) * (size_t)header.cols * header.rows);
+	return true;
+}
+
+//Method designed to write a .demcache file, returns false if it could not be written
+//The file is written under a temporary name and renamed so concurrent loads never see a partial cache
+bool writeDEMCache(const std::string &cacheName, long long sourceSize, long long sourceTime, const DEMHeader &header, const xlib::xarray<float> &heights) {
+	DEMCacheHeader cache;
+	memset(&cache, 0, sizeof(cache));
+	memcpy(cache.magic, "DEMCACHE", 8);
+	cache.version = DEMCACHE_VERSION;
+	cache.byteOrder = DEMCACHE_BYTEORDER;
+	cache.cols = header.cols;
+	cache.rows = header.rows;
+	cache.xCorner = header.xCorner;
+	cache.yCorner = header.yCorner;
+	cache.cellSize = header.cellSize;
+	cache.nodataValue = header.nodataValue;
+	cache.sourceSize = sourceSize;
+	cache.sourceTime = sourceTime;
+
+	std::stringstream tempName;
+	tempName << cacheName << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id());
+	FILE *file = fopen(tempName.str().c_str(), "wb");
+	if (file == NULL) {
+		return false;
+	}
+	size_t count = (size_t)header.cols * header.rows;
+	bool written = fwrite(&cache, sizeof(cache), 1, file) == 1 && fwrite(&heights[0], sizeof(float), count, file) == count;
+	written = fclose(file) == 0 && written;
+#ifdef _WIN32
+	remove(cacheName.c_str());
+#endif
+	if (!written || rename(tempName.str().c_str(), cacheName.c_str()) != 0) {
+		remove(tempName.str().c_str());
+		return false;
+	}
+	return true;
+}
+
+//Method designed to load a DEM, using fileName + ".demcache" when it is up to date and writing it otherwise
+bool loadDEM(const std::string &fileName, DEMHeader &header, xlib::xarray<float> &heights) {
+	long long sourceSize, sourceTime;
+	if (!fileStamp(fileName, sourceSize, sourceTime)) {
+		return false;
+	}
+	std::string cacheName = fileName + ".demcache";
+	if (readDEMCache(cacheName, sourceSize, sourceTime, header, heights)) {
+		std::cout << "Loading DEM cache: " << cacheName << std::endl;
+		return true;
+	}
+
+	std::cout << "Loading ASCII GRID file: " << fileName << std::endl;
+	if (!readDEM_ASCII(fileName, header, heights)) {
+		return false;
+	}
+	if (!writeDEMCache(cacheName, sourceSize, sourceTime, header, heights)) {
+		std::cout << "Warning: Could not write DEM cache: " << cacheName << std::endl;
+	}
+	return true;
+}
+
+#endif
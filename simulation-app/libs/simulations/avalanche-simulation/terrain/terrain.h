@@ -11,8 +11,8 @@
 #define TERRAIN_H
 
 #include "xlib.h"
-#include "terrainquad.h"
 #include "terrainvertex.h"
+#include "demfile.h"
 
 struct Terrain {
 
@@ -20,9 +20,9 @@ struct Terrain {
 	float	yCorner;
 	float	cellSize;
 	xlib::ximage	terrainColor;
-	xlib::xarray<float> heightMap;
-	xlib::xarray<TerrainVertex> verts;
-	xlib::xarray<TerrainQuad> quads;
+	xlib::xarray<float> heightMap;				//height of every cell above the lowest one, rows along z and columns along x
+	vector<xlib::xarray<float> > minHeights;	//min mip pyramid, level l holds the lowest height of each 2^(l+1) x 2^(l+1) block of cells
+	vector<xlib::xarray<float> > maxHeights;	//max mip pyramid, same layout as minHeights
 	
 	//Method designed to export a normal map based on the terrain
 	void exportNormalMap(string filename) {
@@ -43,84 +43,102 @@ struct Terrain {
 	}
 
 	//Method designed to load a DEM file
-	void loadFrom_DEM_ASCII(string fileName, bool genVerts = true) {
-
-		int xSize;
-		int ySize;
-		double nodataValue;
-		string trash;
-		ifstream fin(fileName.c_str());
-		if (fin.fail()) {
+	//The heights are read from the binary fileName.demcache sidecar when it matches the file, otherwise the sidecar is written for the next load
+	void loadFrom_DEM_ASCII(string fileName) {
+
+		DEMHeader header;
+		if (!loadDEM(fileName, header, heightMap)) {
 			cout << "Error: Failed to open file: " << fileName << endl;
 			exit(1);
 		}
 
-		cout << "Loading ASCII GRID file: " << fileName << endl;
-		fin >> trash >> xSize;
-		fin >> trash >> ySize;
-		fin >> trash >> xCorner;
-		fin >> trash >> yCorner;
-		fin >> trash >> cellSize;
-		fin >> trash >> nodataValue;
-
-		heightMap = xlib::xarray<float>(ySize, xSize);
-		if (genVerts) {
-			verts = xlib::xarray<TerrainVertex>(ySize, xSize);
-		}
+		int xSize = header.cols;
+		int ySize = header.rows;
+		double nodataValue = header.nodataValue;
+		xCorner = header.xCorner;
+		yCorner = header.yCorner;
+		cellSize = header.cellSize;
 
-		float maxHeight = 0;
 		float minHeight = 999999;
 		for (int i = 0; i < ySize; i++) {
 			for (int j = 0; j < xSize; j++) {
-				fin >> heightMap(i,j);
 				if (heightMap(i,j) <= nodataValue) {
 					heightMap(i,j) = 0;
 				}
-				if (genVerts) {
-					TerrainVertex v;
-					v.position.x = j * cellSize;
-					v.position.z = i * cellSize;
-					v.position.y = heightMap(i, j);
-					v.texcoords.x = j / float(xSize - 1);
-					v.texcoords.y = 1.0 - (i) / float(ySize - 1);
-					v.texcoords.z = heightMap(i, j);
-					verts(i, j) = v;
-				}
-				if (heightMap(i, j) > maxHeight) {
-					maxHeight = heightMap(i, j);
-				}
 				if (heightMap(i, j) < minHeight) {
 					minHeight = heightMap(i, j);
 				}
 			}
 		}
-		if (genVerts) {
-			quads = xlib::xarray<TerrainQuad>(ySize - 1, xSize - 1);
-			for (int i = 0; i < ySize; i++) {
-				for (int j = 0; j < xSize; j++) {
-					verts(i, j).texcoords.z -= minHeight;
-					verts(i, j).texcoords.z /= maxHeight;
-					verts(i, j).position.y -= minHeight;
-					heightMap(i, j) -= minHeight;
-					//verts(i,j).position.y /= maxHeight;
-				}
+		for (int i = 0; i < ySize; i++) {
+			for (int j = 0; j < xSize; j++) {
+				heightMap(i, j) -= minHeight;
 			}
+		}
+		buildHeightPyramid();
+	}
+
+	//Methods designed to return the number of heightMap rows (along z) and columns (along x)
+	int rows() const {
+		return heightMap.size_x();
+	}
+	int columns() const {
+		return heightMap.size_y();
+	}
 
-			for (int i = 0; i < ySize-1; i++) {
-				for (int j = 0; j < xSize-1; j++) {
-					TerrainQuad q;
-					q.a = j + (xSize) * i;
-					q.b = j+1 + (xSize) * i;
-					q.c = j+1 + (xSize) * (i + 1);
-					q.d = j + (xSize) * (i + 1);
-					quads(i, j) = q;
+	//Method designed to return the render vertex of cell (i, j), built from its height when it is asked for
+	//Nothing but heightMap is stored per cell, the meshes sent to clients are made from these vertices as they are needed
+	TerrainVertex vertex(int i, int j) const {
+		TerrainVertex v;
+		v.position.x = j * cellSize;
+		v.position.y = heightMap(i, j);
+		v.position.z = i * cellSize;
+		v.texcoords.x = j / float(columns() - 1);
+		v.texcoords.y = 1.0 - i / float(rows() - 1);
+		return v;
+	}
+
+	//Method designed to build the min/max mip pyramid over heightMap
+	//Every level halves the previous one (rounding up) until a single block covers the whole terrain
+	void buildHeightPyramid() {
+		minHeights.clear();
+		maxHeights.clear();
+		int sizeX = heightMap.size_x();
+		int sizeY = heightMap.size_y();
+		while (sizeX > 1 || sizeY > 1) {
+			const xlib::xarray<float> &lower = minHeights.empty() ? heightMap : minHeights.back();
+			const xlib::xarray<float> &upper = maxHeights.empty() ? heightMap : maxHeights.back();
+			int nextX = (sizeX + 1) / 2;
+			int nextY = (sizeY + 1) / 2;
+			xlib::xarray<float> levelMin(nextX, nextY);
+			xlib::xarray<float> levelMax(nextX, nextY);
+			for (int i = 0; i < nextX; i++) {
+				for (int j = 0; j < nextY; j++) {
+					int i1 = xlib::clamp(2 * i + 1, 0, sizeX - 1);
+					int j1 = xlib::clamp(2 * j + 1, 0, sizeY - 1);
+					levelMin(i, j) = min(min(lower(2 * i, 2 * j), lower(2 * i, j1)), min(lower(i1, 2 * j), lower(i1, j1)));
+					levelMax(i, j) = max(max(upper(2 * i, 2 * j), upper(2 * i, j1)), max(upper(i1, 2 * j), upper(i1, j1)));
 				}
 			}
+			minHeights.push_back(std::move(levelMin));
+			maxHeights.push_back(std::move(levelMax));
+			sizeX = nextX;
+			sizeY = nextY;
 		}
 	}
 
+	//Method designed to return the height of the highest cell of the terrain
+	float highestPoint() const {
+		return maxHeights.empty() ? heightMap[0] : maxHeights.back()(0, 0);
+	}
+
+	//Method designed to return the normal of a cell, only collisions need one so it is not stored
+	xlib::vec3 normalAt(int i, int j) const {
+		return computeNormal(i, j);
+	}
+
 	//Method designed to compute a normal
-	xlib::vec3 computeNormal(int i, int j) {
+	xlib::vec3 computeNormal(int i, int j) const {
 		if (i < 0) i = 0;
 		if (j < 0) j = 0;
 		if (i >= heightMap.size_x()) i = heightMap.size_x() - 1;
@@ -142,9 +160,52 @@ struct Terrain {
 		xlib::vec3 norm;
 	}
 
+	//Method designed to find the largest pyramid block around cell (z, x) that lies entirely above height y - cellSize
+	//and does not contain cell (endz, endx). A ray at height y cannot hit any cell of that block
+	//Returns false if not even the level 0 block qualifies
+	bool findClearBlock(int z, int x, float y, int endz, int endx, int &z0, int &z1, int &x0, int &x1, float &ceiling) const {
+		bool found = false;
+		for (int level = 0; level < (int)minHeights.size(); level++) {
+			int shift = level + 1;
+			float blockCeiling = minHeights[level](z >> shift, x >> shift) + cellSize;
+			if (!(y <= blockCeiling) || ((z >> shift) == (endz >> shift) && (x >> shift) == (endx >> shift))) {
+				break;
+			}
+			z0 = (z >> shift) << shift;
+			x0 = (x >> shift) << shift;
+			z1 = z0 + (1 << shift);
+			x1 = x0 + (1 << shift);
+			ceiling = blockCeiling;
+			found = true;
+		}
+		return found;
+	}
+
+	//Method designed to count the DDA steps after the current one that keep a coordinate inside [low, high)
+	//The count is rounded down an extra step so rounding in advanceStep can never carry the coordinate out of the range
+	static int stepsInside(int cell, float error, float dir, int low, int high) {
+		if (dir == 0) {
+			return 1 << 30;
+		}
+		float limit = dir > 0 ? high - cell : low - cell - 1;
+		float steps = (limit - error) / dir;
+		if (!(steps < (1 << 30))) {
+			return steps > 0 ? (1 << 30) : 0;
+		}
+		return (int)steps - 1;
+	}
+
+	//Method designed to advance one coordinate of the DDA by the given number of steps at once
+	static void advanceStep(int &cell, float &error, float dir, int steps) {
+		double t = (double)error + (double)steps * dir;
+		int moved = (int)t;
+		cell += moved;
+		error = (float)(t - moved);
+	}
+
 	//Method designed to trace a ray to test for the intersect between the terrain surface and the ray
-	//Uses the DDA stepping ray marching algorithm
-	bool trace(xlib::vec3 start, xlib::vec3 end, xlib::vec3 &hit, xlib::vec3 &normal) {
+	//Uses the DDA stepping ray marching algorithm, jumping across pyramid blocks the ray is known to stay below the top of
+	bool trace(xlib::vec3 start, xlib::vec3 end, xlib::vec3 &hit, xlib::vec3 &normal) const {
 		int x,z;
 		int endx, endz;
 		float y = start.y;
@@ -171,7 +232,7 @@ struct Terrain {
 			hit.x = start.x;
 			hit.z = start.z;
 			hit.y = heightMap(z,x);
-			normal = computeNormal(z,x);
+			normal = normalAt(z,x);
 			return true;
 		}
 		int dx = (dir.x) < 0 ? -1 : 1;
@@ -179,6 +240,10 @@ struct Terrain {
 		int signY = (dir.y) < 0 ? -1 : 1;
 		xlib::vec3 error(0, 0, 0);
 		float dy = dir.y;
+
+		//block of cells every one of which is at least ceiling - cellSize high
+		int blockZ0 = 0, blockZ1 = 0, blockX0 = 0, blockX1 = 0;
+		float blockCeiling = 0;
 	
 		for(;;) {
 			if (x >= heightMap.size_y() || z >= heightMap.size_x() || x < 0 || z < 0 || (x == endx && z == endz)) {
@@ -186,23 +251,44 @@ struct Terrain {
 			}
 			x = xlib::clamp(x, 0, (int)heightMap.size_y() - 1);
 			z = xlib::clamp(z, 0, (int)heightMap.size_x() - 1);
-			
-			float height = heightMap(z,x);
-			
-			int sign = (height  + cellSize - y) < 0 ? -1 : 1;
-			
-			if (sign ==-1) {
-				if (x >= heightMap.size_y() || z >= heightMap.size_x() || x < 0 || z < 0) {
-					return false;
+
+			//inside the current block height + cellSize >= blockCeiling >= y, so the test below cannot pass
+			bool clear = x >= blockX0 && x < blockX1 && z >= blockZ0 && z < blockZ1 && y <= blockCeiling;
+			if (!clear) {
+				float height = heightMap(z,x);
+
+				int sign = (height  + cellSize - y) < 0 ? -1 : 1;
+
+				if (sign ==-1) {
+					if (x >= heightMap.size_y() || z >= heightMap.size_x() || x < 0 || z < 0) {
+						return false;
+					}
+					hit.x = (x+error.x)*cellSize;
+					hit.z = (z+error.z)*cellSize;
+					hit.y = height + cellSize;
+					normal = normalAt(z,x);
+					return true;
 				}
-				hit.x = (x+error.x)*cellSize;
-				hit.z = (z+error.z)*cellSize;
-				hit.y = height + cellSize;
-				normal = computeNormal(z,x);
-				return true;
-			}
 
-			sign = prevSign;
+				sign = prevSign;
+
+				//every cell of the new block is clear, so jump over the steps that stay inside it
+				if (findClearBlock(z, x, y, endz, endx, blockZ0, blockZ1, blockX0, blockX1, blockCeiling)) {
+					int steps = min(stepsInside(x, error.x, dir.x, blockX0, blockX1), stepsInside(z, error.z, dir.z, blockZ0, blockZ1));
+					float rise = (blockCeiling - y) / (dir.y * cellSize);
+					if (dir.y > 0 && rise < steps + 1) {
+						steps = (int)rise - 1;
+					}
+					if (steps > 0) {
+						advanceStep(x, error.x, dir.x, steps);
+						advanceStep(z, error.z, dir.z, steps);
+						y += steps * dir.y * cellSize;
+					}
+				}
+				else {
+					blockZ1 = blockZ0;
+				}
+			}
 
 			error.x += dir.x;
 			error.z += dir.z;
@@ -218,6 +304,131 @@ struct Terrain {
 		}
 		return false;
 	}
+
+	//Method designed to return the normal of sample (i, j) from the central differences of its neighbours
+	xlib::vec3 vertexNormal(int i, int j) const {
+		int i0 = max(i - 1, 0), i1 = min(i + 1, rows() - 1);
+		int j0 = max(j - 1, 0), j1 = min(j + 1, columns() - 1);
+		xlib::vec3 n;
+		n.x = (heightMap(i, j0) - heightMap(i, j1)) / max(j1 - j0, 1);
+		n.z = (heightMap(i0, j) - heightMap(i1, j)) / max(i1 - i0, 1);
+		n.y = cellSize;
+		n.normalize();
+		return n;
+	}
+
+	//Method designed to intersect the segment from start to end with the bilinear surface through the heightMap samples
+	//Unlike trace, which tests against the flat top of every cell raised by cellSize, the hit lies on the surface the clients
+	//draw and the normal is interpolated from the vertexNormal of the corners of the cell, so it turns smoothly from cell
+	//to cell. A start below the surface is reported as a hit at the start, lifted onto the surface.
+	//Returns false if the segment stays above the surface or leaves the terrain first
+	bool traceSurface(xlib::vec3 start, xlib::vec3 end, xlib::vec3 &hit, xlib::vec3 &normal) const {
+		int lastRow = rows() - 1;
+		int lastColumn = columns() - 1;
+
+		//segment in cell units, t runs from 0 at start to 1 at end
+		double x0 = start.x / cellSize, z0 = start.z / cellSize;
+		double dx = (end.x - start.x) / cellSize, dz = (end.z - start.z) / cellSize;
+		int x = (int)floor(x0), z = (int)floor(z0);
+		if (x < 0 || z < 0 || x >= lastColumn || z >= lastRow) {
+			return false;
+		}
+
+		//cells along the segment in order, tNextX/tNextZ are the t at which the segment crosses into the next column/row
+		int stepX = dx < 0 ? -1 : 1;
+		int stepZ = dz < 0 ? -1 : 1;
+		double tDeltaX = dx != 0 ? fabs(1.0 / dx) : DBL_MAX;
+		double tDeltaZ = dz != 0 ? fabs(1.0 / dz) : DBL_MAX;
+		double tNextX = dx != 0 ? (dx > 0 ? x + 1 - x0 : x0 - x) * tDeltaX : DBL_MAX;
+		double tNextZ = dz != 0 ? (dz > 0 ? z + 1 - z0 : z0 - z) * tDeltaZ : DBL_MAX;
+		double t0 = 0;
+		for (;;) {
+			double t1 = min(min(tNextX, tNextZ), 1.0);
+			double t, u, w;
+			if (intersectPatch(z, x, start.y, end.y - start.y, x0 - x, dx, z0 - z, dz, t0, t1, t, u, w)) {
+				hit = start + (end - start) * (float)t;
+				hit.y = patchHeight(z, x, u, w);
+				normal = vertexNormal(z, x) * (float)((1 - u) * (1 - w)) + vertexNormal(z, x + 1) * (float)(u * (1 - w))
+					+ vertexNormal(z + 1, x) * (float)((1 - u) * w) + vertexNormal(z + 1, x + 1) * (float)(u * w);
+				normal.normalize();
+				return true;
+			}
+			if (t1 >= 1.0) {
+				return false;
+			}
+			if (tNextX < tNextZ) {
+				x += stepX;
+				t0 = tNextX;
+				tNextX += tDeltaX;
+			}
+			else {
+				z += stepZ;
+				t0 = tNextZ;
+				tNextZ += tDeltaZ;
+			}
+			if (x < 0 || z < 0 || x >= lastColumn || z >= lastRow) {
+				return false;
+			}
+		}
+	}
+
+	//Method designed to return the height of the bilinear patch of cell (i, j) at u along x and w along z, both in [0, 1]
+	float patchHeight(int i, int j, double u, double w) const {
+		return (float)(heightMap(i, j) * (1 - u) * (1 - w) + heightMap(i, j + 1) * u * (1 - w)
+			+ heightMap(i + 1, j) * (1 - u) * w + heightMap(i + 1, j + 1) * u * w);
+	}
+
+	//Method designed to find the first t in [t0, t1] at which y + dy * t is on or below the bilinear patch of cell (i, j),
+	//with u = u0 + du * t and w = w0 + dw * t the position inside the cell. Along the segment the height above the patch
+	//is a quadratic in t, so its first root is found in closed form; u and w receive the position of the hit
+	bool intersectPatch(int i, int j, double y, double dy, double u0, double du, double w0, double dw, double t0, double t1, double &t, double &u, double &w) const {
+		double h00 = heightMap(i, j), h10 = heightMap(i, j + 1), h01 = heightMap(i + 1, j), h11 = heightMap(i + 1, j + 1);
+		if (min(y + dy * t0, y + dy * t1) > max(max(h00, h10), max(h01, h11))) {
+			return false;
+		}
+
+		//y + dy t - (h00 + a u + c w + k u w) = qa t^2 + qb t + qc
+		double a = h10 - h00, c = h01 - h00, k = h00 - h10 - h01 + h11;
+		double qa = -k * du * dw;
+		double qb = dy - a * du - c * dw - k * (u0 * dw + w0 * du);
+		double qc = y - h00 - a * u0 - c * w0 - k * u0 * w0;
+
+		if (qa * t0 * t0 + qb * t0 + qc <= 0) {
+			t = t0;
+		}
+		else {
+			double roots[2];
+			int count = 0;
+			if (fabs(qa) < 1e-12) {
+				if (qb != 0) {
+					roots[count++] = -qc / qb;
+				}
+			}
+			else {
+				double discriminant = qb * qb - 4 * qa * qc;
+				if (discriminant < 0) {
+					return false;
+				}
+				double q = -0.5 * (qb + (qb < 0 ? -1 : 1) * sqrt(discriminant));
+				roots[count++] = q / qa;
+				if (q != 0) {
+					roots[count++] = qc / q;
+				}
+			}
+			t = DBL_MAX;
+			for (int r = 0; r < count; r++) {
+				if (roots[r] >= t0 && roots[r] <= t1) {
+					t = min(t, roots[r]);
+				}
+			}
+			if (t == DBL_MAX) {
+				return false;
+			}
+		}
+		u = xlib::fclamp(u0 + du * t, 0, 1.0);
+		w = xlib::fclamp(w0 + dw * t, 0, 1.0);
+		return true;
+	}
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,168 @@
+/**
+* terraincache.h
+* @fileoverview .h file designed to share loaded terrains between simulations
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef TERRAINCACHE_H
+#define TERRAINCACHE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <chrono>
+#include <string>
+#include "terrain.h"
+#include "terraintiles.h"
+#include "demfile.h"
+
+//Process wide cache of terrains keyed by DEM and color file, a terrain is only reloaded when one of its files changes
+//Simulations only read their terrain, so every simulation using the same files shares one immutable copy
+//A terrain no simulation uses any more is dropped together with its tiles and meshes, see prune()
+struct TerrainCache {
+
+	//Loaded terrain together with the size and modification time of the files it was built from
+	struct Entry {
+		long long demSize;
+		long long demTime;
+		long long colorSize;
+		long long colorTime;
+		std::shared_future<std::shared_ptr<const Terrain> > terrain;
+		std::map<float, std::shared_ptr<TerrainTileSet> > tiles;	//tile quadtrees of terrain by mesh tolerance, built on first use
+		std::map<float, std::shared_future<std::shared_ptr<const TerrainMesh> > > meshes;	//full meshes of terrain simplified by mesh tolerance, built on first use
+	};
+
+	std::mutex lock;
+	std::map<std::string, Entry> entries;
+
+	//Method designed to return the cache shared by the whole process
+	static TerrainCache& instance() {
+		static TerrainCache cache;
+		return cache;
+	}
+
+	//Method designed to return the terrain built from the given files, loading it if it is not cached or out of date
+	//Concurrent requests for a terrain that is still loading wait for that load instead of starting their own
+	std::shared_ptr<const Terrain> get(const std::string &demFile, const std::string &colorFile) {
+		Entry stamp;
+		if (!fileStamp(demFile, stamp.demSize, stamp.demTime)) {
+			stamp.demSize = stamp.demTime = -1;
+		}
+		if (!fileStamp(colorFile, stamp.colorSize, stamp.colorTime)) {
+			stamp.colorSize = stamp.colorTime = -1;
+		}
+
+		std::string key = demFile + "\n" + colorFile;
+		std::promise<std::shared_ptr<const Terrain> > loaded;
+		std::shared_future<std::shared_ptr<const Terrain> > terrain;
+		bool loading = false;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			dropUnused();
+			std::map<std::string, Entry>::iterator entry = entries.find(key);
+			if (entry != entries.end() && entry->second.demSize == stamp.demSize && entry->second.demTime == stamp.demTime
+				&& entry->second.colorSize == stamp.colorSize && entry->second.colorTime == stamp.colorTime) {
+				terrain = entry->second.terrain;
+			}
+			else {
+				terrain = loaded.get_future().share();
+				stamp.terrain = terrain;
+				entries[key] = stamp;
+				loading = true;
+			}
+		}
+
+		if (loading) {
+			loaded.set_value(load(demFile, colorFile));
+		}
+		return terrain.get();
+	}
+
+	//Method designed to return the tile quadtree of a terrain, shared by every simulation using the terrain and tolerance
+	//A terrain that is no longer cached, because one of its files changed, gets a quadtree of its own
+	std::shared_ptr<TerrainTileSet> tiles(const std::shared_ptr<const Terrain> &terrain, float tolerance) {
+		std::lock_guard<std::mutex> guard(lock);
+		for (std::map<std::string, Entry>::iterator entry = entries.begin(); entry != entries.end(); entry++) {
+			if (entry->second.terrain.wait_for(std::chrono::seconds(0)) == std::future_status::ready && entry->second.terrain.get() == terrain) {
+				std::shared_ptr<TerrainTileSet> &tiles = entry->second.tiles[tolerance];
+				if (!tiles) {
+					tiles = std::make_shared<TerrainTileSet>(terrain, tolerance);
+				}
+				return tiles;
+			}
+		}
+		return std::make_shared<TerrainTileSet>(terrain, tolerance);
+	}
+
+	//Method designed to return the full mesh of a terrain simplified to a tolerance, shared by every simulation using them
+	//The first request builds the mesh, concurrent requests wait for that build instead of starting their own
+	std::shared_ptr<const TerrainMesh> mesh(const std::shared_ptr<const Terrain> &terrain, float tolerance) {
+		std::promise<std::shared_ptr<const TerrainMesh> > built;
+		std::shared_future<std::shared_ptr<const TerrainMesh> > mesh;
+		bool building = false;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			for (std::map<std::string, Entry>::iterator entry = entries.begin(); entry != entries.end(); entry++) {
+				if (entry->second.terrain.wait_for(std::chrono::seconds(0)) == std::future_status::ready && entry->second.terrain.get() == terrain) {
+					std::shared_future<std::shared_ptr<const TerrainMesh> > &cached = entry->second.meshes[tolerance];
+					if (!cached.valid()) {
+						cached = built.get_future().share();
+						building = true;
+					}
+					mesh = cached;
+					break;
+				}
+			}
+		}
+
+		if (!mesh.valid()) {
+			//the terrain is no longer cached, it gets a mesh of its own
+			return simplify(*terrain, tolerance);
+		}
+		if (building) {
+			built.set_value(simplify(*terrain, tolerance));
+		}
+		return mesh.get();
+	}
+
+	//Method designed to drop every terrain that is only referenced by the cache itself, called once a simulation is removed
+	void prune() {
+		std::lock_guard<std::mutex> guard(lock);
+		dropUnused();
+	}
+
+	//Method designed to erase the entries whose terrain is held by nothing but the entry and its tile quadtrees, lock must be held
+	//Once that is the case nothing outside the cache can take a new reference to the terrain, so the count cannot grow again
+	void dropUnused() {
+		std::map<std::string, Entry>::iterator entry = entries.begin();
+		while (entry != entries.end()) {
+			if (entry->second.terrain.wait_for(std::chrono::seconds(0)) == std::future_status::ready
+				&& entry->second.terrain.get().use_count() <= 1 + (long)entry->second.tiles.size()) {
+				entry = entries.erase(entry);
+			}
+			else {
+				entry++;
+			}
+		}
+	}
+
+	//Method designed to simplify the whole heightMap of a terrain
+	static std::shared_ptr<const TerrainMesh> simplify(const Terrain &terrain, float tolerance) {
+		std::shared_ptr<TerrainMesh> mesh = std::make_shared<TerrainMesh>();
+		TerrainSimplifier().simplify(&terrain.heightMap[0], terrain.rows(), terrain.columns(), tolerance, mesh->vertices, mesh->indices);
+		return mesh;
+	}
+
+	//Method designed to build a terrain from its DEM and color files
+	static std::shared_ptr<const Terrain> load(const std::string &demFile, const std::string &colorFile) {
+		std::shared_ptr<Terrain> terrain = std::make_shared<Terrain>();
+		terrain->loadFrom_DEM_ASCII(demFile);
+		terrain->terrainColor.importFrom_BMP(colorFile);
+		terrain->terrainColor = terrain->terrainColor.resizedTo(512, 512);
+		return terrain;
+	}
+};
+
+#endif
@@ -1,18 +0,0 @@
-/**
-* particlequad.h
-* @fileoverview .h file designed to define a terrain quad struct
-* @author Unknown
-* Created: Unknown
-*/
-
-#ifndef TERRAINQUAD_H
-#define TERRAINQUAD_H
-
-struct TerrainQuad {
-	unsigned int a;
-	unsigned int b;
-	unsigned int c;
-	unsigned int d;
-};
-
-#endif
\ No newline at end of file
@@ -0,0 +1,178 @@
+/**
+* terrainsimplifier.h
+* @fileoverview .h file designed to triangulate a grid of heights with as few triangles as a height tolerance allows
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef TERRAINSIMPLIFIER_H
+#define TERRAINSIMPLIFIER_H
+
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+//Triangulation of a grid of heights produced by TerrainSimplifier
+struct TerrainMesh {
+	std::vector<int> vertices;				//grid points (r * columns + c) used by the mesh, in increasing order
+	std::vector<unsigned int> indices;		//three entries of vertices for every triangle
+};
+
+//Right triangulated irregular network (RTIN) over a grid of heights
+//
+//The grid is covered by two right triangles that are split in half at the midpoint of their hypotenuse, recursively,
+//wherever interpolating the heights over the triangle misses a grid height inside it by more than the tolerance. The error of a
+//midpoint includes the errors of every midpoint below it, so both triangles sharing a hypotenuse always make the same
+//choice and the mesh has no cracks. Flat ground ends up as a few large triangles, ridges and gullies keep every cell.
+//
+//RTIN needs a square grid of 2^k + 1 points; other grids are padded and every triangle crossing the edge of the real
+//grid is split until it lies on one side, so the mesh covers the grid exactly.
+struct TerrainSimplifier {
+
+	//Method designed to triangulate a rows x columns grid of row major heights so that no height is further than
+	//tolerance from the mesh, vertices receives the used grid points (r * columns + c) in increasing order and indices
+	//three entries of vertices for every triangle
+	void simplify(const float *heights, int rows, int columns, float tolerance, std::vector<int> &vertices, std::vector<unsigned int> &indices) {
+		vertices.clear();
+		indices.clear();
+		if (rows < 2 || columns < 2) {
+			return;
+		}
+		lastRow = rows - 1;
+		lastColumn = columns - 1;
+		size = 2;
+		while (size - 1 < std::max(lastRow, lastColumn)) {
+			size = (size - 1) * 2 + 1;
+		}
+		this->heights = heights;
+		this->columns = columns;
+		computeErrors();
+
+		//walk the triangles that are kept
+		triangles.clear();
+		int last = size - 1;
+		addTriangle(0, 0, last, last, last, 0, tolerance);
+		addTriangle(last, last, 0, 0, 0, last, tolerance);
+
+		//number the used grid points in grid order
+		used.assign(rows * columns, -1);
+		for (size_t t = 0; t < triangles.size(); t++) {
+			used[triangles[t]] = 0;
+		}
+		for (int point = 0; point < rows * columns; point++) {
+			if (used[point] == 0) {
+				used[point] = (int)vertices.size();
+				vertices.push_back(point);
+			}
+		}
+		indices.resize(triangles.size());
+		for (size_t t = 0; t < triangles.size(); t++) {
+			indices[t] = used[triangles[t]];
+		}
+	}
+
+private:
+	const float *heights;
+	int columns;
+	int lastRow;
+	int lastColumn;
+	int size;							//points along each side of the padded grid
+	std::vector<float> errors;			//error of the triangles split at every point of the padded grid
+	std::vector<int> triangles;			//grid points of the kept triangles
+	std::vector<int> used;				//vertex number of every grid point, -1 if it is not used
+
+	//Method designed to return the height of a point of the padded grid, the last row and column are repeated
+	float height(int x, int y) const {
+		return heights[std::min(y, lastRow) * columns + std::min(x, lastColumn)];
+	}
+
+	//Method designed to fill errors, every triangle of a level is visited before those of the level above it
+	//Triangle i has id i + 2, whose bits from the lowest one up choose the halves on the way down from the two roots
+	void computeErrors() {
+		int last = size - 1;
+		errors.assign(size * size, 0);
+		int triangleCount = last * last * 2 - 2;
+		int parentCount = triangleCount - last * last;
+		for (int i = triangleCount - 1; i >= 0; i--) {
+			int id = i + 2;
+			int ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0;
+			if (id & 1) {
+				bx = by = cx = last;
+			}
+			else {
+				ax = ay = cy = last;
+			}
+			while ((id >>= 1) > 1) {
+				int mx = (ax + bx) >> 1;
+				int my = (ay + by) >> 1;
+				if (id & 1) {
+					bx = ax; by = ay;
+					ax = cx; ay = cy;
+				}
+				else {
+					ax = bx; ay = by;
+					bx = cx; by = cy;
+				}
+				cx = mx; cy = my;
+			}
+
+			int mx = (ax + bx) >> 1;
+			int my = (ay + by) >> 1;
+			float &error = errors[my * size + mx];
+			int lowX = std::min(ax, std::min(bx, cx)), highX = std::max(ax, std::max(bx, cx));
+			int lowY = std::min(ay, std::min(by, cy)), highY = std::max(ay, std::max(by, cy));
+			if (lowX >= lastColumn || lowY >= lastRow) {
+				//padding only, dropped from the mesh
+				continue;
+			}
+			if (highX > lastColumn || highY > lastRow) {
+				//crosses the edge of the real grid, always split
+				error = FLT_MAX;
+				continue;
+			}
+			error = std::max(error, deviation(ax, ay, bx, by, cx, cy));
+			if (i < parentCount) {
+				error = std::max(error, std::max(errors[((ay + cy) >> 1) * size + ((ax + cx) >> 1)], errors[((by + cy) >> 1) * size + ((bx + cx) >> 1)]));
+			}
+		}
+	}
+
+	//Method designed to return how far the grid heights inside a triangle are from the plane through its corners
+	//Every level of triangles covers the grid once, so all levels together cost a few dozen visits of every point
+	float deviation(int ax, int ay, int bx, int by, int cx, int cy) const {
+		int area = (bx - ax) * (cy - ay) - (cx - ax) * (by - ay);
+		float ha = height(ax, ay);
+		float slopeX = ((height(bx, by) - ha) * (cy - ay) - (height(cx, cy) - ha) * (by - ay)) / area;
+		float slopeY = ((height(cx, cy) - ha) * (bx - ax) - (height(bx, by) - ha) * (cx - ax)) / area;
+		int sign = area > 0 ? 1 : -1;
+		float largest = 0;
+		for (int y = std::min(ay, std::min(by, cy)); y <= std::max(ay, std::max(by, cy)); y++) {
+			for (int x = std::min(ax, std::min(bx, cx)); x <= std::max(ax, std::max(bx, cx)); x++) {
+				if (sign * ((bx - ax) * (y - ay) - (by - ay) * (x - ax)) < 0 || sign * ((cx - bx) * (y - by) - (cy - by) * (x - bx)) < 0
+					|| sign * ((ax - cx) * (y - cy) - (ay - cy) * (x - cx)) < 0) {
+					continue;
+				}
+				largest = std::max(largest, std::fabs(ha + (x - ax) * slopeX + (y - ay) * slopeY - height(x, y)));
+			}
+		}
+		return largest;
+	}
+
+	//Method designed to keep a triangle with hypotenuse a-b and right angle at c, or split it if it is not accurate enough
+	void addTriangle(int ax, int ay, int bx, int by, int cx, int cy, float tolerance) {
+		int mx = (ax + bx) >> 1;
+		int my = (ay + by) >> 1;
+		if (std::abs(ax - cx) + std::abs(ay - cy) > 1 && errors[my * size + mx] > tolerance) {
+			addTriangle(cx, cy, ax, ay, mx, my, tolerance);
+			addTriangle(bx, by, cx, cy, mx, my, tolerance);
+		}
+		else if (std::max(ax, std::max(bx, cx)) <= lastColumn && std::max(ay, std::max(by, cy)) <= lastRow) {
+			triangles.push_back(ay * columns + ax);
+			triangles.push_back(by * columns + bx);
+			triangles.push_back(cy * columns + cx);
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,240 @@
+/**
+* terraintiles.h
+* @fileoverview .h file designed to split a terrain into a quadtree of tiles at decreasing levels of detail
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef TERRAINTILES_H
+#define TERRAINTILES_H
+
+#include <vector>
+#include <list>
+#include <map>
+#include <mutex>
+#include <memory>
+#include "terrain.h"
+#include "terrainsimplifier.h"
+
+#define TERRAIN_TILE_CELLS			64					//cells along each side of a tile at its own level of detail, a power of two
+#define TERRAIN_TILE_CACHE_BYTES	(64 << 20)			//size of the tiles kept by a TerrainTileSet, the least recently used ones are dropped
+
+//Mesh of one tile of a TerrainTileSet
+//The grid vertices come first, row by row, followed by a skirt: a copy of the border vertices lowered by skirtDepth.
+//With a tolerance only the grid vertices kept by TerrainSimplifier are stored.
+//The skirt hides the gaps between neighbouring tiles of different levels, whose edges only share every other vertex.
+struct TerrainTile {
+	int level;								//0 is the single root tile, levels - 1 the tiles at full heightMap resolution
+	int x;									//column of the tile within its level
+	int z;									//row of the tile within its level
+	int step;								//heightMap cells between neighbouring vertices
+	int rows;								//grid points along z
+	int columns;							//grid points along x
+	float skirtDepth;						//distance the skirt hangs below the border
+	std::vector<float> positions;			//x,y,z of every vertex
+	std::vector<float> textureCoordinates;	//u,v of every vertex
+	std::vector<unsigned short> indices;	//triangles of the grid and the skirt
+
+	//Method designed to return the memory held by the tile
+	size_t bytes() const {
+		return sizeof(TerrainTile) + positions.size() * sizeof(float) + textureCoordinates.size() * sizeof(float) + indices.size() * sizeof(unsigned short);
+	}
+};
+
+//Quadtree of tiles over a terrain, every tile covers the area of its four children with a quarter of their vertices
+//
+//The root tile at level 0 covers the whole terrain, the tiles of the last level sample every heightMap cell. Tiles are built
+//from Terrain::vertex() the first time they are requested and cached, so a client can draw the root within milliseconds of
+//loading a large DEM and only pays for the detail of the tiles it looks at.
+//A tolerance above 0 additionally simplifies every tile, so flat parts of a tile take a few triangles.
+struct TerrainTileSet {
+
+	//Constructor, tolerance is the largest height error of a tile against its own grid
+	TerrainTileSet(std::shared_ptr<const Terrain> terrain, float tolerance = 0) : terrain(terrain), tolerance(tolerance) {
+		int cells = std::max(terrain->rows(), terrain->columns()) - 1;
+		levels = 1;
+		while ((TERRAIN_TILE_CELLS << (levels - 1)) < cells) {
+			levels++;
+		}
+		cachedBytes = 0;
+	}
+
+	//Method designed to return the number of levels
+	int levelCount() const {
+		return levels;
+	}
+
+	//Method designed to return the number of heightMap cells between neighbouring vertices of a level
+	int levelStep(int level) const {
+		return 1 << (levels - 1 - level);
+	}
+
+	//Methods designed to return the number of tiles along x and z of a level
+	int tilesX(int level) const {
+		int span = TERRAIN_TILE_CELLS * levelStep(level);
+		return std::max((terrain->columns() - 1 + span - 1) / span, 1);
+	}
+	int tilesZ(int level) const {
+		int span = TERRAIN_TILE_CELLS * levelStep(level);
+		return std::max((terrain->rows() - 1 + span - 1) / span, 1);
+	}
+
+	//Method designed to return a tile, NULL if it is outside the quadtree
+	std::shared_ptr<const TerrainTile> tile(int level, int x, int z) {
+		if (level < 0 || level >= levels || x < 0 || z < 0 || x >= tilesX(level) || z >= tilesZ(level)) {
+			return std::shared_ptr<const TerrainTile>();
+		}
+
+		std::lock_guard<std::mutex> guard(lock);
+		long long key = ((long long)level << 48) | ((long long)z << 24) | x;
+		std::map<long long, CachedTile>::iterator cached = tiles.find(key);
+		if (cached != tiles.end()) {
+			used.splice(used.begin(), used, cached->second.use);
+			return cached->second.tile;
+		}
+
+		std::shared_ptr<const TerrainTile> built = build(level, x, z);
+		used.push_front(key);
+		CachedTile entry = { built, used.begin() };
+		tiles[key] = entry;
+		cachedBytes += built->bytes();
+		while (cachedBytes > TERRAIN_TILE_CACHE_BYTES && used.size() > 1) {
+			std::map<long long, CachedTile>::iterator oldest = tiles.find(used.back());
+			cachedBytes -= oldest->second.tile->bytes();
+			tiles.erase(oldest);
+			used.pop_back();
+		}
+		return built;
+	}
+
+private:
+	//Tile of the cache together with its place in the use order
+	struct CachedTile {
+		std::shared_ptr<const TerrainTile> tile;
+		std::list<long long>::iterator use;
+	};
+
+	std::shared_ptr<const Terrain> terrain;
+	float tolerance;
+	int levels;
+	std::mutex lock;						//guards the cache
+	std::map<long long, CachedTile> tiles;	//built tiles keyed by level, z and x
+	std::list<long long> used;				//keys of the cached tiles, most recently used first
+	size_t cachedBytes;
+
+	//Method designed to build the mesh of a tile
+	std::shared_ptr<const TerrainTile> build(int level, int x, int z) const {
+		std::shared_ptr<TerrainTile> tile = std::make_shared<TerrainTile>();
+		tile->level = level;
+		tile->x = x;
+		tile->z = z;
+		tile->step = levelStep(level);
+		int span = TERRAIN_TILE_CELLS * tile->step;
+		int lastRow = terrain->rows() - 1;
+		int lastColumn = terrain->columns() - 1;
+		int row0 = z * span;
+		int column0 = x * span;
+		tile->rows = std::min((lastRow - row0 + tile->step - 1) / tile->step, TERRAIN_TILE_CELLS) + 1;
+		tile->columns = std::min((lastColumn - column0 + tile->step - 1) / tile->step, TERRAIN_TILE_CELLS) + 1;
+
+		//the skirt only has to cover the height range of the tile, which the max/min pyramid block of the same size holds
+		//the root may be larger than the terrain, its block is then the single one of the last pyramid level
+		int pyramidLevel = std::min(log2(span) - 1, (int)terrain->minHeights.size() - 1);
+		float range = pyramidLevel < 0 ? 0 : terrain->maxHeights[pyramidLevel](z, x) - terrain->minHeights[pyramidLevel](z, x);
+		//a simplified neighbour may be off by the tolerance in the other direction
+		tile->skirtDepth = std::min(range, tile->step * terrain->cellSize + 2 * tolerance);
+
+		//grid vertices, number[p] is the vertex of grid point p or -1 if the simplified mesh does not use it
+		std::vector<TerrainVertex> grid;
+		for (int r = 0; r < tile->rows; r++) {
+			for (int c = 0; c < tile->columns; c++) {
+				grid.push_back(terrain->vertex(std::min(row0 + r * tile->step, lastRow), std::min(column0 + c * tile->step, lastColumn)));
+			}
+		}
+		std::vector<int> number(grid.size(), -1);
+		if (tolerance > 0) {
+			std::vector<float> heights(grid.size());
+			for (size_t p = 0; p < grid.size(); p++) {
+				heights[p] = grid[p].position.y;
+			}
+			std::vector<int> vertices;
+			std::vector<unsigned int> triangles;
+			TerrainSimplifier().simplify(heights.data(), tile->rows, tile->columns, tolerance, vertices, triangles);
+			for (size_t v = 0; v < vertices.size(); v++) {
+				number[vertices[v]] = (int)v;
+				addVertex(*tile, grid[vertices[v]], 0);
+			}
+			tile->indices.assign(triangles.begin(), triangles.end());
+		}
+		else {
+			for (size_t p = 0; p < grid.size(); p++) {
+				number[p] = (int)p;
+				addVertex(*tile, grid[p], 0);
+			}
+			for (int r = 0; r + 1 < tile->rows; r++) {
+				for (int c = 0; c + 1 < tile->columns; c++) {
+					int a = r * tile->columns + c;
+					addQuad(*tile, a, a + 1, a + tile->columns + 1, a + tile->columns);
+				}
+			}
+		}
+
+		//skirt around the border, walked clockwise over the vertices the mesh uses
+		std::vector<int> border;
+		for (int c = 0; c < tile->columns - 1; c++) {
+			border.push_back(c);
+		}
+		for (int r = 0; r < tile->rows - 1; r++) {
+			border.push_back(r * tile->columns + tile->columns - 1);
+		}
+		for (int c = tile->columns - 1; c > 0; c--) {
+			border.push_back((tile->rows - 1) * tile->columns + c);
+		}
+		for (int r = tile->rows - 1; r > 0; r--) {
+			border.push_back(r * tile->columns);
+		}
+		border.erase(std::remove_if(border.begin(), border.end(), [&number](int p) { return number[p] < 0; }), border.end());
+		for (size_t b = 0; b < border.size(); b++) {
+			border[b] = number[border[b]];
+		}
+		int skirt = (int)tile->positions.size() / 3;
+		for (int b = 0; b < (int)border.size(); b++) {
+			int v = border[b];
+			TerrainVertex vertex;
+			vertex.position = xlib::vec3(tile->positions[v * 3 + 0], tile->positions[v * 3 + 1], tile->positions[v * 3 + 2]);
+			vertex.texcoords = xlib::vec2(tile->textureCoordinates[v * 2 + 0], tile->textureCoordinates[v * 2 + 1]);
+			addVertex(*tile, vertex, tile->skirtDepth);
+		}
+		for (int b = 0; b < (int)border.size(); b++) {
+			int next = (b + 1) % border.size();
+			addQuad(*tile, border[b], border[next], skirt + next, skirt + b);
+		}
+		return tile;
+	}
+
+	//Method designed to append a vertex lowered by depth to a tile
+	static void addVertex(TerrainTile &tile, const TerrainVertex &vertex, float depth) {
+		tile.positions.push_back(vertex.position.x);
+		tile.positions.push_back(vertex.position.y - depth);
+		tile.positions.push_back(vertex.position.z);
+		tile.textureCoordinates.push_back(vertex.texcoords.x);
+		tile.textureCoordinates.push_back(vertex.texcoords.y);
+	}
+
+	//Method designed to append the triangles (a, d, b) and (b, c, d) of a quad to a tile, the order used by the full mesh
+	static void addQuad(TerrainTile &tile, int a, int b, int c, int d) {
+		unsigned short triangles[6] = { (unsigned short)a, (unsigned short)d, (unsigned short)b, (unsigned short)b, (unsigned short)c, (unsigned short)d };
+		tile.indices.insert(tile.indices.end(), triangles, triangles + 6);
+	}
+
+	//Method designed to return the base 2 logarithm of a power of two
+	static int log2(int value) {
+		int bits = 0;
+		while ((1 << (bits + 1)) <= value) {
+			bits++;
+		}
+		return bits;
+	}
+};
+
+#endif
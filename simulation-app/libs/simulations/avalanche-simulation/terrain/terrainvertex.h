@@ -12,11 +12,10 @@
 
 #include "xlib.h"
 
+//Vertex of the terrain meshes sent to clients, see Terrain::vertex()
 struct TerrainVertex {
 	xlib::vec3 position;
-	xlib::vec3 normal;
-	xlib::vec3 texcoords;
-	xlib::vec3 color;
+	xlib::vec2 texcoords;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,106 @@
+/**
+* workerpool.h
+* @fileoverview .h file designed to provide a fixed size pool of worker threads
+* @author Unknown
+* Created: October 17th, 2026
+*/
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+
+//The thread calling run() acts as worker 0, so a pool of size n only spawns n - 1 threads
+struct WorkerPool {
+
+	std::vector<std::thread> threads;
+	std::mutex runLock;					//serializes callers sharing the same pool
+	std::mutex lock;
+	std::condition_variable startSignal;
+	std::condition_variable doneSignal;
+	std::function<void(int)> task;
+	unsigned int generation;			//incremented every time a new task is published
+	int pending;						//number of spawned workers still running the current task
+	bool stopping;
+
+	//Constructor
+	WorkerPool(int size) {
+		generation = 0;
+		pending = 0;
+		stopping = false;
+		for (int worker = 1; worker < size; worker++) {
+			threads.push_back(std::thread(&WorkerPool::workerLoop, this, worker));
+		}
+	}
+
+	//Destructor
+	~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stopping = true;
+		}
+		startSignal.notify_all();
+		for (int i = 0; i < (int)threads.size(); i++) {
+			threads[i].join();
+		}
+	}
+
+	//Method designed to return the number of workers including the calling thread
+	int size() const {
+		return (int)threads.size() + 1;
+	}
+
+	//Method designed to run job(worker) once on every worker and block until all of them finish
+	void run(const std::function<void(int)> &job) {
+		std::lock_guard<std::mutex> runGuard(runLock);
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			task = job;
+			pending = (int)threads.size();
+			generation++;
+		}
+		startSignal.notify_all();
+
+		job(0);
+
+		std::unique_lock<std::mutex> guard(lock);
+		doneSignal.wait(guard, [this]() { return pending == 0; });
+	}
+
+	//Method designed to compute the contiguous [begin, end) range of count items owned by a worker
+	static void range(int worker, int workers, int count, int &begin, int &end) {
+		begin = (int)((long long)count * worker / workers);
+		end = (int)((long long)count * (worker + 1) / workers);
+	}
+
+	//Method run by each spawned thread, waits for a task and executes it
+	void workerLoop(int worker) {
+		unsigned int seen = 0;
+		for (;;) {
+			std::function<void(int)> job;
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				startSignal.wait(guard, [&]() { return stopping || generation != seen; });
+				if (stopping) {
+					return;
+				}
+				seen = generation;
+				job = task;
+			}
+
+			job(worker);
+
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				pending--;
+			}
+			doneSignal.notify_one();
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * exportsimulationflowpath.h
+ * @fileoverview .h file designed to provide a method to export the flow path of a simulation
+ * @author Unknown
+ * Created: October 17th, 2026
+ */
+
+#ifndef EXPORTSIMULATIONFLOWPATH_H
+#define EXPORTSIMULATIONFLOWPATH_H
+
+//Method designed to write the forceMap accumulated so far to the flowPathOutputFile of the simulation
+void exportSimulationFlowPath(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.exportFlowPath();
+
+    //Set return
+    info.GetReturnValue().Set(Nan::New(true));
+}
+
+#endif
@@ -25,14 +25,99 @@ void skipSimulationFrames(const Nan::FunctionCallbackInfo<v8::Value> &info) {
 		return;
 	}
 
-	MassMovementSimulator &simulator = simulations[id];
+	MassMovementSimulator &simulator = *simulations[id];
+	std::lock_guard<SimulationLock> guard(simulator.stepLock);
 
 	for (int i = 0; i < steps; i++) {
 		//Update all particles
-		simulations[id].updateAllParticles();
+		simulator.updateAllParticles();
 	}
 }
 
+//Method designed to write the particle with the given index into slot index of the frame buffers of the simulation
+//The color is gathered from the entry of its grid cell, computeCellColors() has to be called for the frame first
+void writeFrameParticle(MassMovementSimulator &simulator, int particle, int index) {
+    float x = simulator.particles.px[particle];
+    float z = simulator.particles.pz[particle];
+    simulator.frameVertices[index * 3 + 0] = x;
+    simulator.frameVertices[index * 3 + 1] = simulator.particles.py[particle];
+    simulator.frameVertices[index * 3 + 2] = z;
+    memcpy(&simulator.frameColors[index * 3], simulator.densityColors.color(simulator.cellColors[simulator.densityCell(x, z)]), 3);
+}
+
+//Method designed to fill the frame buffers of the simulation with the particles picked for the given vertex budget
+//(0 for every particle), returns the vertex count
+int fillSampledSimulationFrame(MassMovementSimulator &simulator, int budget) {
+    int vertexCount = simulator.selectFrameParticles(budget);
+    simulator.reserveFrame(vertexCount);
+    simulator.computeCellColors();
+    for (int index = 0; index < vertexCount; index++) {
+        writeFrameParticle(simulator, simulator.frameParticles[index], index);
+    }
+    return vertexCount;
+}
+
+//Method designed to fill the frame buffers of the simulation with every particle, or frameBudget particles sampled
+//over the grid when it is set, returns the vertex count
+int fillSimulationFrame(MassMovementSimulator &simulator) {
+    return fillSampledSimulationFrame(simulator, simulator.frameBudget);
+}
+
+//Method designed to fill the frame buffers of the simulation with about one particle per grid cell, or frameBudget
+//particles when it is set, returns the vertex count
+int fillSimulationFrameFromGrid(MassMovementSimulator &simulator) {
+    return fillSampledSimulationFrame(simulator, simulator.frameBudget > 0 ? simulator.frameBudget : simulator.particleGrid.size());
+}
+
+//Method designed to copy vertexCount packed vertices and colors into a frame object
+//The frame holds one Float32Array of x,y,z positions and one Uint8Array of r,g,b colors so that
+//socket.io can send them as binary attachments
+v8::Local<v8::Object> buildFrameObject(v8::Isolate *isolate, const float *vertices, const unsigned char *colors, int vertexCount) {
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+    size_t verticesSize = vertexCount * 3 * sizeof(float);
+    v8::Local<v8::ArrayBuffer> verticesBuffer = v8::ArrayBuffer::New(isolate, verticesSize);
+    if (vertexCount > 0) {
+        memcpy(verticesBuffer->GetContents().Data(), vertices, verticesSize);
+    }
+
+    size_t colorsSize = vertexCount * 3 * sizeof(unsigned char);
+    v8::Local<v8::ArrayBuffer> colorsBuffer = v8::ArrayBuffer::New(isolate, colorsSize);
+    if (vertexCount > 0) {
+        memcpy(colorsBuffer->GetContents().Data(), colors, colorsSize);
+    }
+
+    //Create key strings
+    v8::Local<v8::String> verticesStr = v8::String::NewFromUtf8(isolate, "vertices");
+    v8::Local<v8::String> colorsStr = v8::String::NewFromUtf8(isolate, "colors");
+    v8::Local<v8::String> vertexCountStr = v8::String::NewFromUtf8(isolate, "vertexCount");
+
+    //Add to frame
+    v8::Local<v8::Object> frame = v8::Object::New(isolate);
+    frame->Set(context, verticesStr, v8::Float32Array::New(verticesBuffer, 0, vertexCount * 3));
+    frame->Set(context, colorsStr, v8::Uint8Array::New(colorsBuffer, 0, vertexCount * 3));
+    frame->Set(context, vertexCountStr, Nan::New(vertexCount));
+    return frame;
+}
+
+//Method designed to fill the frame buffers of the simulation with every particle and encode them into out
+//See frameencoder.h for the layout, vertex i of the decoded frame is particle i unless frameBudget is set
+void encodeSimulationFrame(MassMovementSimulator &simulator, std::vector<unsigned char> &out) {
+    int vertexCount = fillSimulationFrame(simulator);
+    xlib::vec3 low, high;
+    simulator.frameBounds(low, high);
+    simulator.frameEncoder.encode(&simulator.frameVertices[0], &simulator.frameColors[0], vertexCount, low, high, out);
+}
+
+//Method designed to copy an encoded frame into a Uint8Array so that socket.io can send it as a binary attachment
+v8::Local<v8::Object> buildEncodedFrameObject(v8::Isolate *isolate, const unsigned char *data, size_t size) {
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, size);
+    if (size > 0) {
+        memcpy(buffer->GetContents().Data(), data, size);
+    }
+    return v8::Uint8Array::New(buffer, 0, size);
+}
+
 //Method designed to get the next frame for the simulation indexed by the given id
 void getNextSimulationFrame(const Nan::FunctionCallbackInfo<v8::Value> &info) {
     //Params checking
@@ -51,65 +136,17 @@ void getNextSimulationFrame(const Nan::FunctionCallbackInfo<v8::Value> &info) {
         return;
     }
 
-    //v8 variables
-    v8::Isolate* isolate = info.GetIsolate();
-    v8::Local<v8::Context> context = v8::Context::New(isolate);
-
-    MassMovementSimulator &simulator = simulations[id];
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
 
     //Update all particles
-    simulations[id].updateAllParticles();
+    simulator.updateAllParticles();
 
     //Build frame
-    v8::Local<v8::Array> vertices = v8::Array::New(isolate, 0);
-    v8::Local<v8::Array> colors = v8::Array::New(isolate, 0);
-
-    v8::Local<v8::Array> vertex;
-    v8::Local<v8::Array> color;
-
-    float alpha;
-    int alphai;
-    float w;
-
-    for (int index = 0; index < simulator.particles.size(); index++) { //TODO attempt to pick every 10th particle
-        Particle &particle = simulator.particles[index];
-
-        vertex = v8::Array::New(isolate, 3);
-        color = v8::Array::New(isolate, 3);
-
-        //Set vertex x,y,z
-        vertex->Set(0, Nan::New(particle.position.x)); //TODO see what Edwards thinks
-        vertex->Set(1, Nan::New(particle.position.y)); //TODO see what Edwards thinks
-        vertex->Set(2, Nan::New(particle.position.z)); //TODO see what Edwards thinks
-
-        //Add to vertices
-        vertices->Set(index, vertex);
-
-        //Determine color
-        alpha = 0.0001 * simulator.computeDensity(particle.position.x, particle.position.z);
-        alpha = pow(xlib::fclamp((6.0 - alpha) / 6.0, 0, 1.0), 2.0f) * 5.999;
-        alphai = (int)alpha;
-        w = alpha - alphai;
-        
-        color->Set(0, Nan::New(particleDensityColor[alphai].x * (1.0 - w) + particleDensityColor[xlib::clamp(alphai + 1, 0, 5)].x * (w)));
-        color->Set(1, Nan::New(particleDensityColor[alphai].y * (1.0 - w) + particleDensityColor[xlib::clamp(alphai + 1, 0, 5)].y * (w)));
-        color->Set(2, Nan::New(particleDensityColor[alphai].z * (1.0 - w) + particleDensityColor[xlib::clamp(alphai + 1, 0, 5)].z * (w)));
-
-        //Add to colors
-        colors->Set(index, color);
-    }
-
-    //Create key strings
-    v8::Local<v8::String> verticesStr = v8::String::NewFromUtf8(isolate, "vertices");
-    v8::Local<v8::String> colorsStr = v8::String::NewFromUtf8(isolate, "colors");
-
-    //Add to frame
-    v8::Local<v8::Object> frame = v8::Object::New(isolate);
-    frame->Set(context, verticesStr, vertices);
-    frame->Set(context, colorsStr, colors);    
+    int vertexCount = fillSimulationFrame(simulator);
 
     //Set return Value
-    info.GetReturnValue().Set(frame);
+    info.GetReturnValue().Set(buildFrameObject(info.GetIsolate(), &simulator.frameVertices[0], &simulator.frameColors[0], vertexCount));
 }
 
 //Method designed to get the next simulation frame using the grid
@@ -130,80 +167,84 @@ void getNextSimulationFrameFromGrid(const Nan::FunctionCallbackInfo<v8::Value> &
         return;
     }
 
-    //v8 variables
-    v8::Isolate* isolate = info.GetIsolate();
-    v8::Local<v8::Context> context = v8::Context::New(isolate);
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+
+    //Update all particles
+    simulator.updateAllParticles();
+
+    //Build frame
+    int vertexCount = fillSimulationFrameFromGrid(simulator);
+
+    //Set return Value
+    info.GetReturnValue().Set(buildFrameObject(info.GetIsolate(), &simulator.frameVertices[0], &simulator.frameColors[0], vertexCount));
+}
+
+//Method designed to get the next frame for the simulation indexed by the given id as an encoded frame
+void getNextEncodedSimulationFrame(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id already exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
 
-    MassMovementSimulator &simulator = simulations[id];
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
 
     //Update all particles
     simulator.updateAllParticles();
 
     //Build frame
-    v8::Local<v8::Array> vertices = v8::Array::New(isolate, 0);
-    v8::Local<v8::Array> colors = v8::Array::New(isolate, 0);
-
-    xlib::xarray<Particle> &particles = simulator.particles;
-    int particleCount = 0;
-
-    float alpha;
-    int alphai;
-    float w;
-
-    for (int i = 0; i < simulator.particleGrid.size_x(); i++) {
-        for (int j = 0; j < simulator.particleGrid.size_y(); j++) {
-            std::vector<int> &particleBucket = simulator.particleGrid(i, j).particles;
-
-            if (particleBucket.size() > 0) {
-                int size = 0;
-                if (particleBucket.size() > 4) { //TODO target density
-                    size = 4;
-                }
-                else {
-                    size = particleBucket.size();
-                }
-                for (int index = 0; index < size; index++) {
-					Particle &particle = particles[particleBucket[index]];
-
-                    v8::Local<v8::Array> vertex = v8::Array::New(isolate, 3);
-                    v8::Local<v8::Array> color = v8::Array::New(isolate, 3);
-
-                    vertex->Set(0, v8::Number::New(isolate, particle.position.x));
-                    vertex->Set(1, v8::Number::New(isolate, particle.position.y));
-                    vertex->Set(2, v8::Number::New(isolate, particle.position.z));
-
-                    //Add to vertices
-                    vertices->Set(particleCount, vertex);
-
-                    //Determine color
-                    alpha = 0.0001 * simulator.computeDensity(particle.position.x, particle.position.z);
-                    alpha = pow(xlib::fclamp((6.0 - alpha) / 6.0, 0, 1.0), 2.0f) * 5.999;
-                    alphai = (int)alpha;
-                    w = alpha - alphai;
-                    
-                    color->Set(0, Nan::New(particleDensityColor[alphai].x * (1.0 - w) + particleDensityColor[xlib::clamp(alphai + 1, 0, 5)].x * (w)));
-                    color->Set(1, Nan::New(particleDensityColor[alphai].y * (1.0 - w) + particleDensityColor[xlib::clamp(alphai + 1, 0, 5)].y * (w)));
-                    color->Set(2, Nan::New(particleDensityColor[alphai].z * (1.0 - w) + particleDensityColor[xlib::clamp(alphai + 1, 0, 5)].z * (w)));
-
-                    //Add to colors
-                    colors->Set(particleCount, color);
-                    particleCount++;
-                }
-            }
-        }
+    std::vector<unsigned char> frame;
+    encodeSimulationFrame(simulator, frame);
+
+    //Set return Value
+    info.GetReturnValue().Set(buildEncodedFrameObject(info.GetIsolate(), frame.data(), frame.size()));
+}
+
+//Method designed to tell the simulation indexed by the given id that the client received an encoded keyframe
+//Later encoded frames are sent as deltas against the newest acknowledged keyframe
+//Frames read from a scheduler are acknowledged to the scheduler, see simulationschedulers.h
+void acknowledgeSimulationFrame(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsNumber()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, number frame)");
+        return;
     }
 
-    //Create key strings
-    v8::Local<v8::String> verticesStr = v8::String::NewFromUtf8(isolate, "vertices");
-    v8::Local<v8::String> colorsStr = v8::String::NewFromUtf8(isolate, "colors");
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+    unsigned int frame = (unsigned int)info[1]->NumberValue();
 
-    //Add to frame
-    v8::Local<v8::Object> frame = v8::Object::New(isolate);
-    frame->Set(context, verticesStr, vertices);
-    frame->Set(context, colorsStr, colors);    
+    //Check if the id already exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    if (schedulers.count(id) == 1) {
+        SimulationScheduler &scheduler = *schedulers[id];
+        std::lock_guard<std::mutex> guard(scheduler.encoderLock);
+        info.GetReturnValue().Set(Nan::New(scheduler.encoder.acknowledge(frame)));
+        return;
+    }
+
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
 
     //Set return Value
-    info.GetReturnValue().Set(frame);
+    info.GetReturnValue().Set(Nan::New(simulator.frameEncoder.acknowledge(frame)));
 }
 
 #endif
\ No newline at end of file
@@ -8,7 +8,77 @@
 #ifndef GETSIMULATIONTERRAINDATA_H
 #define GETSIMULATIONTERRAINDATA_H
 
-//Method designed to get terrain vertices and texture coordinates
+//Method designed to build the object sent to the clients for a terrain mesh
+//Returns {positions, textureCoordinates, indices, vertexCount, indexCount} where positions is a Float32Array of x,y,z,
+//textureCoordinates a Float32Array of u,v and indices a Uint32Array holding two triangles for every heightMap cell,
+//so socket.io can send the arrays as binary attachments
+//With a simplified mesh from TerrainCache::mesh only its vertices and triangles are sent
+v8::Local<v8::Object> buildTerrainDataObject(v8::Isolate *isolate, const Terrain &terrain, const TerrainMesh *mesh) {
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+    int rows = terrain.rows();
+    int columns = terrain.columns();
+    int vertexCount = mesh ? (int)mesh->vertices.size() : rows * columns;
+    int indexCount = mesh ? (int)mesh->indices.size() : (rows - 1) * (columns - 1) * 6;
+
+    //Shared vertices, vertex v is cell (v / columns, v % columns), or the v-th cell the simplified mesh uses
+    v8::Local<v8::ArrayBuffer> positionsBuffer = v8::ArrayBuffer::New(isolate, vertexCount * 3 * sizeof(float));
+    v8::Local<v8::ArrayBuffer> textureCoordinatesBuffer = v8::ArrayBuffer::New(isolate, vertexCount * 2 * sizeof(float));
+    float *positions = (float*)positionsBuffer->GetContents().Data();
+    float *textureCoordinates = (float*)textureCoordinatesBuffer->GetContents().Data();
+    for (int v = 0; v < vertexCount; v++) {
+        int cell = mesh ? mesh->vertices[v] : v;
+        TerrainVertex vertex = terrain.vertex(cell / columns, cell % columns);
+        positions[v * 3 + 0] = vertex.position.x;
+        positions[v * 3 + 1] = vertex.position.y;
+        positions[v * 3 + 2] = vertex.position.z;
+        textureCoordinates[v * 2 + 0] = vertex.texcoords.x;
+        textureCoordinates[v * 2 + 1] = vertex.texcoords.y;
+    }
+
+    //Triangles (a, d, b) and (b, c, d) of the quad a = (i, j), b = (i, j + 1), c = (i + 1, j + 1), d = (i + 1, j) of every cell,
+    //or the triangles of the simplified mesh
+    v8::Local<v8::ArrayBuffer> indicesBuffer = v8::ArrayBuffer::New(isolate, indexCount * sizeof(unsigned int));
+    unsigned int *indices = (unsigned int*)indicesBuffer->GetContents().Data();
+    if (mesh) {
+        memcpy(indices, mesh->indices.data(), indexCount * sizeof(unsigned int));
+    }
+    else {
+        unsigned int *quad = indices;
+        for (int i = 0; i < rows - 1; i++) {
+            for (int j = 0; j < columns - 1; j++) {
+                unsigned int a = i * columns + j;
+                quad[0] = a;
+                quad[1] = a + columns;
+                quad[2] = a + 1;
+                quad[3] = a + 1;
+                quad[4] = a + columns + 1;
+                quad[5] = a + columns;
+                quad += 6;
+            }
+        }
+    }
+
+    //Create key strings
+    v8::Local<v8::String> positionsStr = v8::String::NewFromUtf8(isolate, "positions");
+    v8::Local<v8::String> textureCoordinatesStr = v8::String::NewFromUtf8(isolate, "textureCoordinates");
+    v8::Local<v8::String> indicesStr = v8::String::NewFromUtf8(isolate, "indices");
+    v8::Local<v8::String> vertexCountStr = v8::String::NewFromUtf8(isolate, "vertexCount");
+    v8::Local<v8::String> indexCountStr = v8::String::NewFromUtf8(isolate, "indexCount");
+
+    //Add to terrain data
+    v8::Local<v8::Object> terrainData = v8::Object::New(isolate);
+    terrainData->Set(context, positionsStr, v8::Float32Array::New(positionsBuffer, 0, vertexCount * 3));
+    terrainData->Set(context, textureCoordinatesStr, v8::Float32Array::New(textureCoordinatesBuffer, 0, vertexCount * 2));
+    terrainData->Set(context, indicesStr, v8::Uint32Array::New(indicesBuffer, 0, indexCount));
+    terrainData->Set(context, vertexCountStr, Nan::New(vertexCount));
+    terrainData->Set(context, indexCountStr, Nan::New(indexCount));
+    return terrainData;
+}
+
+//Method designed to get the terrain mesh of a simulation as shared vertices and an index buffer, see buildTerrainDataObject
+//With a meshTolerance the first request for a terrain simplifies its whole heightMap on the main thread,
+//getSimulationTerrainDataAsync does that on a thread pool thread instead
 void getSimulationTerrainData(const Nan::FunctionCallbackInfo<v8::Value> &info) {
     //Params checking
     if (info.Length() != 1 || !info[0]->IsString()) {
@@ -26,125 +96,65 @@ void getSimulationTerrainData(const Nan::FunctionCallbackInfo<v8::Value> &info)
         return;
     }
 
-    //v8 variables
-    v8::Isolate* isolate = info.GetIsolate();
-    v8::Local<v8::Context> context = v8::Context::New(isolate);
-
-    Terrain &terrain = simulations[id].terrain;
-
-    v8::Local<v8::Array> vertices = v8::Array::New(isolate, 0);
-    v8::Local<v8::Array> textureCoordinates = v8::Array::New(isolate, 0);
-    int nextAddIndex = 0;
-
-    v8::Local<v8::Array> vertex;
-    v8::Local<v8::Array> textureCoordinate;
-
-    //Generate terrain vertices
-    for (int i = 0; i < terrain.verts.size_x() - 1; i++) {
-        for (int j = 0; j < terrain.verts.size_y() - 1; j++) {
-            vertex = v8::Array::New(isolate, 3);
-            textureCoordinate = v8::Array::New(isolate, 2);
-            
-            //Triangle 1 - Vertex 1
-            vertex->Set(0, v8::Number::New(isolate, terrain.verts(i, j).position.x));
-            vertex->Set(1, v8::Number::New(isolate, terrain.verts(i, j).position.y));
-            vertex->Set(2, v8::Number::New(isolate, terrain.verts(i, j).position.z));
-
-            textureCoordinate->Set(0, v8::Number::New(isolate, terrain.verts(i, j).texcoords.x));
-            textureCoordinate->Set(1, v8::Number::New(isolate, terrain.verts(i, j).texcoords.y));
-
-            vertices->Set(nextAddIndex, vertex);
-            textureCoordinates->Set(nextAddIndex, textureCoordinate);
-            nextAddIndex++;
-
-            vertex = v8::Array::New(isolate, 3);
-            textureCoordinate = v8::Array::New(isolate, 2);
-
-            //Triangle 1 - Vertex 2
-            vertex->Set(0, v8::Number::New(isolate, terrain.verts(i + 1, j).position.x));
-            vertex->Set(1, v8::Number::New(isolate, terrain.verts(i + 1, j).position.y));
-            vertex->Set(2, v8::Number::New(isolate, terrain.verts(i + 1, j).position.z));
-
-            textureCoordinate->Set(0, v8::Number::New(isolate, terrain.verts(i + 1, j).texcoords.x));
-            textureCoordinate->Set(1, v8::Number::New(isolate, terrain.verts(i + 1, j).texcoords.y));
-
-            vertices->Set(nextAddIndex, vertex);
-            textureCoordinates->Set(nextAddIndex, textureCoordinate);
-            nextAddIndex++;
-
-            vertex = v8::Array::New(isolate, 3);
-            textureCoordinate = v8::Array::New(isolate, 2);
-
-            //Triangle 1 - Vertex 3
-            vertex->Set(0, v8::Number::New(isolate, terrain.verts(i, j + 1).position.x));
-            vertex->Set(1, v8::Number::New(isolate, terrain.verts(i, j + 1).position.y));
-            vertex->Set(2, v8::Number::New(isolate, terrain.verts(i, j + 1).position.z));
-
-            textureCoordinate->Set(0, v8::Number::New(isolate, terrain.verts(i, j + 1).texcoords.x));
-            textureCoordinate->Set(1, v8::Number::New(isolate, terrain.verts(i, j + 1).texcoords.y));
-
-            vertices->Set(nextAddIndex, vertex);
-            textureCoordinates->Set(nextAddIndex, textureCoordinate);
-            nextAddIndex++;
-
-            vertex = v8::Array::New(isolate, 3);
-            textureCoordinate = v8::Array::New(isolate, 2);
-
-            //Triangle 2 - Vertex 1
-            vertex->Set(0, v8::Number::New(isolate, terrain.verts(i, j + 1).position.x));
-            vertex->Set(1, v8::Number::New(isolate, terrain.verts(i, j + 1).position.y));
-            vertex->Set(2, v8::Number::New(isolate, terrain.verts(i, j + 1).position.z));
-
-            textureCoordinate->Set(0, v8::Number::New(isolate, terrain.verts(i, j + 1).texcoords.x));
-            textureCoordinate->Set(1, v8::Number::New(isolate, terrain.verts(i, j + 1).texcoords.y));
-
-            vertices->Set(nextAddIndex, vertex);
-            textureCoordinates->Set(nextAddIndex, textureCoordinate);
-            nextAddIndex++;
-
-            vertex = v8::Array::New(isolate, 3);
-            textureCoordinate = v8::Array::New(isolate, 2);
+    std::shared_ptr<const TerrainMesh> mesh;
+    if (simulations[id]->meshTolerance > 0) {
+        mesh = TerrainCache::instance().mesh(simulations[id]->terrain, simulations[id]->meshTolerance);
+    }
 
-            //Triangle 2 - Vertex 2
-            vertex->Set(0, v8::Number::New(isolate, terrain.verts(i + 1, j + 1).position.x));
-            vertex->Set(1, v8::Number::New(isolate, terrain.verts(i + 1, j + 1).position.y));
-            vertex->Set(2, v8::Number::New(isolate, terrain.verts(i + 1, j + 1).position.z));
+    //Set return Value
+    info.GetReturnValue().Set(buildTerrainDataObject(info.GetIsolate(), *simulations[id]->terrain, mesh.get()));
+}
 
-            textureCoordinate->Set(0, v8::Number::New(isolate, terrain.verts(i + 1, j + 1).texcoords.x));
-            textureCoordinate->Set(1, v8::Number::New(isolate, terrain.verts(i + 1, j + 1).texcoords.y));
+//Worker that fetches the simplified mesh of a terrain from TerrainCache, building it on first use
+class TerrainDataWorker : public Nan::AsyncWorker {
+public:
+    //Constructor
+    TerrainDataWorker(Nan::Callback *callback, std::shared_ptr<const Terrain> terrain, float tolerance)
+        : Nan::AsyncWorker(callback), terrain(terrain), tolerance(tolerance) {
+    }
 
-            vertices->Set(nextAddIndex, vertex);
-            textureCoordinates->Set(nextAddIndex, textureCoordinate);
-            nextAddIndex++;
+    //Method run on a thread pool thread
+    void Execute() {
+        if (tolerance > 0) {
+            mesh = TerrainCache::instance().mesh(terrain, tolerance);
+        }
+    }
 
-            vertex = v8::Array::New(isolate, 3);
-            textureCoordinate = v8::Array::New(isolate, 2);
+    //Method run on the main thread once Execute has finished
+    void HandleOKCallback() {
+        Nan::HandleScope scope;
 
-            //Triangle 2 - Vertex 3
-            vertex->Set(0, v8::Number::New(isolate, terrain.verts(i + 1, j).position.x));
-            vertex->Set(1, v8::Number::New(isolate, terrain.verts(i + 1, j).position.y));
-            vertex->Set(2, v8::Number::New(isolate, terrain.verts(i + 1, j).position.z));
+        v8::Local<v8::Value> argv[] = { Nan::Null(), buildTerrainDataObject(v8::Isolate::GetCurrent(), *terrain, mesh.get()) };
+        callback->Call(2, argv);
+    }
 
-            textureCoordinate->Set(0, v8::Number::New(isolate, terrain.verts(i + 1, j).texcoords.x));
-            textureCoordinate->Set(1, v8::Number::New(isolate, terrain.verts(i + 1, j).texcoords.y));
+private:
+    std::shared_ptr<const Terrain> terrain;
+    float tolerance;
+    std::shared_ptr<const TerrainMesh> mesh;
+};
 
-            vertices->Set(nextAddIndex, vertex);
-            textureCoordinates->Set(nextAddIndex, textureCoordinate);
-            nextAddIndex++;
-        }
+//Method designed to get the terrain mesh of a simulation without simplifying it on the main thread
+//Takes (string id, function callback), the callback receives the same object as getSimulationTerrainData
+void getSimulationTerrainDataAsync(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsFunction()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, function callback)");
+        return;
     }
 
-    //Create key strings
-    v8::Local<v8::String> verticesStr = v8::String::NewFromUtf8(isolate, "vertices");
-    v8::Local<v8::String> textureCoordinatesStr = v8::String::NewFromUtf8(isolate, "textureCoordinates");
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
 
-    //Add to frame
-    v8::Local<v8::Object> terrainData = v8::Object::New(isolate);
-    terrainData->Set(context, verticesStr, vertices);
-    terrainData->Set(context, textureCoordinatesStr, textureCoordinates);    
+    //Check if the id already exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
 
-    //Set return Value
-    info.GetReturnValue().Set(terrainData);
+    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+    Nan::AsyncQueueWorker(new TerrainDataWorker(callback, simulations[id]->terrain, simulations[id]->meshTolerance));
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+/**
+ * getsimulationterraintiles.h
+ * @fileoverview .h file designed to provide methods to stream the terrain of a simulation as a quadtree of tiles
+ * @author Unknown
+ * Created: October 17th, 2026
+ */
+
+#ifndef GETSIMULATIONTERRAINTILES_H
+#define GETSIMULATIONTERRAINTILES_H
+
+//Method designed to get the layout of the terrain tile quadtree of a simulation
+//Returns {levels, tileCells, cellSize, rows, columns, tilesX, tilesZ} where tilesX and tilesZ are arrays holding the
+//number of tiles along x and z of every level, level 0 being the single root tile
+void getSimulationTerrainTileInfo(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id already exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    //v8 variables
+    v8::Isolate* isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+    const Terrain &terrain = *simulations[id]->terrain;
+    std::shared_ptr<TerrainTileSet> tiles = TerrainCache::instance().tiles(simulations[id]->terrain, simulations[id]->meshTolerance);
+    int levels = tiles->levelCount();
+    v8::Local<v8::Array> tilesX = v8::Array::New(isolate, levels);
+    v8::Local<v8::Array> tilesZ = v8::Array::New(isolate, levels);
+    for (int level = 0; level < levels; level++) {
+        tilesX->Set(level, Nan::New(tiles->tilesX(level)));
+        tilesZ->Set(level, Nan::New(tiles->tilesZ(level)));
+    }
+
+    //Add to tile info
+    v8::Local<v8::Object> tileInfo = v8::Object::New(isolate);
+    tileInfo->Set(context, v8::String::NewFromUtf8(isolate, "levels"), Nan::New(levels));
+    tileInfo->Set(context, v8::String::NewFromUtf8(isolate, "tileCells"), Nan::New(TERRAIN_TILE_CELLS));
+    tileInfo->Set(context, v8::String::NewFromUtf8(isolate, "cellSize"), Nan::New(terrain.cellSize));
+    tileInfo->Set(context, v8::String::NewFromUtf8(isolate, "rows"), Nan::New(terrain.rows()));
+    tileInfo->Set(context, v8::String::NewFromUtf8(isolate, "columns"), Nan::New(terrain.columns()));
+    tileInfo->Set(context, v8::String::NewFromUtf8(isolate, "tilesX"), tilesX);
+    tileInfo->Set(context, v8::String::NewFromUtf8(isolate, "tilesZ"), tilesZ);
+
+    //Set return Value
+    info.GetReturnValue().Set(tileInfo);
+}
+
+//Method designed to get one tile of the terrain quadtree of a simulation, built on first request and cached afterwards
+//Takes (string id, number level, number x, number z) and returns {level, x, z, positions, textureCoordinates, indices,
+//vertexCount, indexCount} with the same layout as getSimulationTerrainData except for indices being a Uint16Array,
+//or null if there is no such tile
+void getSimulationTerrainTile(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 4 || !info[0]->IsString() || !info[1]->IsNumber() || !info[2]->IsNumber() || !info[3]->IsNumber()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, number level, number x, number z)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+    int level = (int)info[1]->NumberValue();
+    int x = (int)info[2]->NumberValue();
+    int z = (int)info[3]->NumberValue();
+
+    //Check if the id already exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    std::shared_ptr<const TerrainTile> tile = TerrainCache::instance().tiles(simulations[id]->terrain, simulations[id]->meshTolerance)->tile(level, x, z);
+    if (!tile) {
+        info.GetReturnValue().Set(Nan::Null());
+        return;
+    }
+
+    //v8 variables
+    v8::Isolate* isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+    //Copy the cached tile, the cache may drop it while socket.io still sends the arrays
+    int vertexCount = (int)tile->positions.size() / 3;
+    int indexCount = (int)tile->indices.size();
+    v8::Local<v8::ArrayBuffer> positionsBuffer = v8::ArrayBuffer::New(isolate, tile->positions.size() * sizeof(float));
+    v8::Local<v8::ArrayBuffer> textureCoordinatesBuffer = v8::ArrayBuffer::New(isolate, tile->textureCoordinates.size() * sizeof(float));
+    v8::Local<v8::ArrayBuffer> indicesBuffer = v8::ArrayBuffer::New(isolate, tile->indices.size() * sizeof(unsigned short));
+    memcpy(positionsBuffer->GetContents().Data(), tile->positions.data(), tile->positions.size() * sizeof(float));
+    memcpy(textureCoordinatesBuffer->GetContents().Data(), tile->textureCoordinates.data(), tile->textureCoordinates.size() * sizeof(float));
+    memcpy(indicesBuffer->GetContents().Data(), tile->indices.data(), tile->indices.size() * sizeof(unsigned short));
+
+    //Add to tile data
+    v8::Local<v8::Object> tileData = v8::Object::New(isolate);
+    tileData->Set(context, v8::String::NewFromUtf8(isolate, "level"), Nan::New(tile->level));
+    tileData->Set(context, v8::String::NewFromUtf8(isolate, "x"), Nan::New(tile->x));
+    tileData->Set(context, v8::String::NewFromUtf8(isolate, "z"), Nan::New(tile->z));
+    tileData->Set(context, v8::String::NewFromUtf8(isolate, "positions"), v8::Float32Array::New(positionsBuffer, 0, tile->positions.size()));
+    tileData->Set(context, v8::String::NewFromUtf8(isolate, "textureCoordinates"), v8::Float32Array::New(textureCoordinatesBuffer, 0, tile->textureCoordinates.size()));
+    tileData->Set(context, v8::String::NewFromUtf8(isolate, "indices"), v8::Uint16Array::New(indicesBuffer, 0, indexCount));
+    tileData->Set(context, v8::String::NewFromUtf8(isolate, "vertexCount"), Nan::New(vertexCount));
+    tileData->Set(context, v8::String::NewFromUtf8(isolate, "indexCount"), Nan::New(indexCount));
+
+    //Set return Value
+    info.GetReturnValue().Set(tileData);
+}
+
+#endif
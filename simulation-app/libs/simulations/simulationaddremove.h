@@ -33,8 +33,7 @@ void addSimulation(const Nan::FunctionCallbackInfo<v8::Value> &info) {
     }
 
     //Add simulation
-    MassMovementSimulator simulator = buildSimulator(datafile, settingsfile);
-    simulations.insert(pair<string, MassMovementSimulator>(id, simulator));
+    simulations.emplace(id, buildSharedSimulator(datafile, settingsfile));
 
     logToFile("Simulation created with id: " + id);
 
@@ -60,8 +59,17 @@ void removeSimulation(const Nan::FunctionCallbackInfo<v8::Value> &info) {
         return;
     }
 
-    //Remove simulation
+    //Stop stepping it on its own thread
+    if (schedulers.count(id) == 1) {
+        schedulers[id]->stop();
+        schedulers.erase(id);
+    }
+
+    //Remove simulation, steps still running in the background keep their own reference to it
     simulations.erase(id);
+
+    //Free its terrain if no other simulation uses it
+    TerrainCache::instance().prune();
     
     logToFile("Simulation deleted with id: " + id);
 
@@ -0,0 +1,210 @@
+/**
+ * simulationasync.h
+ * @fileoverview .h file designed to provide versions of the simulation functions that run off the main thread
+ * @author Unknown
+ * Created: October 17th, 2026
+ */
+
+#ifndef SIMULATIONASYNC_H
+#define SIMULATIONASYNC_H
+
+//Every function in this file takes a node style callback(error, result) as its last parameter.
+//The work runs on the libuv thread pool, holding the lock of the simulation it steps.
+
+//Display frame built by a SimulationStepWorker once it has stepped the simulation
+enum StepFrame {
+    STEP_NO_FRAME,          //only step, the callback receives true
+    STEP_RAW_FRAME,         //callback receives a frame object built by buildFrameObject
+    STEP_ENCODED_FRAME      //callback receives a Uint8Array built by buildEncodedFrameObject
+};
+
+//Worker that steps a simulation and optionally builds a display frame
+class SimulationStepWorker : public Nan::AsyncWorker {
+public:
+    //Constructor
+    SimulationStepWorker(Nan::Callback *callback, std::shared_ptr<MassMovementSimulator> simulator, int steps, StepFrame frame)
+        : Nan::AsyncWorker(callback), simulator(simulator), steps(steps), frame(frame), vertexCount(0) {
+    }
+
+    //Method run on a thread pool thread
+    void Execute() {
+        std::lock_guard<SimulationLock> guard(simulator->stepLock);
+
+        for (int i = 0; i < steps; i++) {
+            simulator->updateAllParticles();
+        }
+
+        if (frame == STEP_RAW_FRAME) {
+            //Copy the frame out of the simulation, it may be stepped again before the callback runs
+            vertexCount = fillSimulationFrame(*simulator);
+            vertices.assign(&simulator->frameVertices[0], &simulator->frameVertices[0] + vertexCount * 3);
+            colors.assign(&simulator->frameColors[0], &simulator->frameColors[0] + vertexCount * 3);
+        }
+        else if (frame == STEP_ENCODED_FRAME) {
+            encodeSimulationFrame(*simulator, encoded);
+        }
+    }
+
+    //Method run on the main thread once Execute has finished
+    void HandleOKCallback() {
+        Nan::HandleScope scope;
+
+        v8::Local<v8::Value> result;
+        if (frame == STEP_RAW_FRAME) {
+            result = buildFrameObject(v8::Isolate::GetCurrent(), vertices.data(), colors.data(), vertexCount);
+        }
+        else if (frame == STEP_ENCODED_FRAME) {
+            result = buildEncodedFrameObject(v8::Isolate::GetCurrent(), encoded.data(), encoded.size());
+        }
+        else {
+            result = Nan::New(true);
+        }
+
+        v8::Local<v8::Value> argv[] = { Nan::Null(), result };
+        callback->Call(2, argv);
+    }
+
+private:
+    std::shared_ptr<MassMovementSimulator> simulator;
+    int steps;
+    StepFrame frame;
+    int vertexCount;
+    std::vector<float> vertices;
+    std::vector<unsigned char> colors;
+    std::vector<unsigned char> encoded;
+};
+
+//Worker that loads and initializes a new simulation
+class SimulationBuildWorker : public Nan::AsyncWorker {
+public:
+    //Constructor
+    SimulationBuildWorker(Nan::Callback *callback, string id, string datafile, string settingsfile)
+        : Nan::AsyncWorker(callback), id(id), datafile(datafile), settingsfile(settingsfile) {
+    }
+
+    //Method run on a thread pool thread
+    void Execute() {
+        simulator = buildSharedSimulator(datafile, settingsfile);
+    }
+
+    //Method run on the main thread once Execute has finished, the simulation is only published here
+    void HandleOKCallback() {
+        Nan::HandleScope scope;
+
+        //Another simulation with the same id may have been added while this one was loading
+        if (simulations.count(id) == 1) {
+            v8::Local<v8::Value> argv[] = { Nan::Error(("A simulation with id: " + id + " already exists").c_str()) };
+            callback->Call(1, argv);
+            return;
+        }
+
+        simulations.emplace(id, std::move(simulator));
+        logToFile("Simulation created with id: " + id);
+
+        v8::Local<v8::Value> argv[] = { Nan::Null(), Nan::New(true) };
+        callback->Call(2, argv);
+    }
+
+private:
+    string id;
+    string datafile;
+    string settingsfile;
+    std::shared_ptr<MassMovementSimulator> simulator;
+};
+
+//Method designed to add a new simulation using the supplied id without blocking the main thread
+void addSimulationAsync(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 4 || !info[0]->IsString() || !info[3]->IsFunction()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, string datafile, string settingsfile, function callback)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    v8::String::Utf8Value param2(info[1]->ToString());
+    string datafile = string(*param2);
+
+    v8::String::Utf8Value param3(info[2]->ToString());
+    string settingsfile = string(*param3);
+
+    //Check if the id already exists
+    if (simulations.count(id) == 1) {
+        Nan::ThrowTypeError(("A simulation with id: " + id + " already exists").c_str());
+        return;
+    }
+
+    Nan::Callback *callback = new Nan::Callback(info[3].As<v8::Function>());
+    Nan::AsyncQueueWorker(new SimulationBuildWorker(callback, id, datafile, settingsfile));
+}
+
+//Method designed to step the simulation indexed by the given id and build its next frame without blocking the main thread
+void getNextSimulationFrameAsync(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsFunction()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, function callback)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+    Nan::AsyncQueueWorker(new SimulationStepWorker(callback, simulations[id], 1, STEP_RAW_FRAME));
+}
+
+//Method designed to step the simulation indexed by the given id and build its next encoded frame without blocking the main thread
+void getNextEncodedSimulationFrameAsync(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsFunction()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, function callback)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+    Nan::AsyncQueueWorker(new SimulationStepWorker(callback, simulations[id], 1, STEP_ENCODED_FRAME));
+}
+
+//Method designed to drop the given number of frames of the simulation indexed by the given id without blocking the main thread
+void skipSimulationFramesAsync(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 3 || !info[0]->IsString() || !info[1]->IsNumber() || !info[2]->IsFunction()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, number steps, function callback)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+    int steps = (int)info[1]->NumberValue();
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
+    Nan::AsyncQueueWorker(new SimulationStepWorker(callback, simulations[id], steps, STEP_NO_FRAME));
+}
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * simulationbatch.cpp
+ * @fileoverview .cpp file designed to run parameter sweeps and ensembles of a simulation without node
+ * @author Unknown
+ * Created: October 17th, 2026
+ *
+ * Usage (from the simulation-app directory):
+ *   simulationbatch [--jobs n] [--output prefix] [--checkpoint steps] datafile settingsfile batchfile
+ * See parseBatch() in simulationbatch.h for the batch file format.
+ * With --checkpoint every run writes <prefix>run_n.checkpoint and an interrupted batch resumes from those files.
+ */
+
+//Includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <vector>
+#include <map>
+#include <memory>
+
+//Custom files
+#include "xlib.h"
+#include "massmovementsimulator.h"
+#include "simulationfactory.h"
+#include "simulationbatch.h"
+
+using namespace std;
+
+//Method designed to return the name of the forceMap file of a run
+string runFileName(const string &prefix, int run) {
+    stringstream name;
+    name << prefix << "run_" << run << ".bmp";
+    return name.str();
+}
+
+//Method designed to write the settings and metrics of every run as csv, returns false if the file cannot be written
+bool writeSummary(const string &fileName, const string &prefix, const vector<BatchRun> &runs, const vector<BatchResult> &results) {
+    ofstream fout(fileName.c_str());
+    if (fout.fail()) {
+        cout << "ERROR: Failed to open file: " << fileName << endl;
+        return false;
+    }
+
+    fout << "run";
+    for (int p = 0; p < (int)runs[0].params.size(); p++) {
+        fout << "," << runs[0].params[p];
+    }
+    fout << ",steps,resumedStep,secondsSinceResume,particles,active,sleeping,coveredPixels,forceMapSum,maxForce,pathError,forceMapFile" << endl;
+
+    for (int r = 0; r < (int)runs.size(); r++) {
+        const BatchResult &result = results[r];
+        fout << r;
+        for (int p = 0; p < (int)runs[r].values.size(); p++) {
+            fout << "," << runs[r].values[p];
+        }
+        fout << "," << result.steps << "," << result.resumedStep << "," << result.seconds << "," << result.particles << "," << result.active
+            << "," << result.sleeping << "," << result.coveredPixels << "," << result.forceMapSum << "," << result.maxForce << "," << result.pathError
+            << "," << runFileName(prefix, r) << endl;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    SimulationBatch batch;
+    string prefix = "batch_";
+    vector<string> files;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--jobs" && a + 1 < argc) {
+            batch.jobs = atoi(argv[++a]);
+        }
+        else if (arg == "--output" && a + 1 < argc) {
+            prefix = argv[++a];
+        }
+        else if (arg == "--checkpoint" && a + 1 < argc) {
+            batch.checkpointSteps = atoi(argv[++a]);
+        }
+        else if (arg[0] == '-') {
+            cout << "Usage: simulationbatch [--jobs n] [--output prefix] [--checkpoint steps] datafile settingsfile batchfile" << endl;
+            return 1;
+        }
+        else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != 3) {
+        cout << "ERROR: Expected a data file, a settings file and a batch file" << endl;
+        return 1;
+    }
+
+    batch.checkpointPrefix = prefix;
+    vector<BatchRun> runs;
+    if (!parseBatch(files[2], runs) || !batch.init(files[0], files[1])) {
+        return 1;
+    }
+    printf("runs       %d\n", (int)runs.size());
+    printf("jobs       %d\n", xlib::clamp(batch.jobs, 1, (int)runs.size()));
+
+    vector<BatchResult> results;
+    long long start = SimulationProfile::now();
+    batch.run(runs, results, [&](int run, MassMovementSimulator &simulator) {
+        simulator.flowPathOutputFile = runFileName(prefix, run);
+        simulator.exportFlowPath();
+        printf("run %d finished in %.1f s\n", run, results[run].seconds);
+        fflush(stdout);
+    });
+    printf("wall time  %.1f s\n", (SimulationProfile::now() - start) / 1e9);
+
+    return writeSummary(prefix + "summary.csv", prefix, runs, results) ? 0 : 1;
+}
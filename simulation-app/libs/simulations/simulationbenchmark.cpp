@@ -0,0 +1,172 @@
+/**
+ * simulationbenchmark.cpp
+ * @fileoverview .cpp file designed to benchmark the simulation core without node
+ * @author Unknown
+ * Created: October 17th, 2026
+ *
+ * Usage (from the simulation-app directory):
+ *   simulationbenchmark [--steps n] [--threads n] [--scalar] [--check] [datafile settingsfile]
+ * Without a data and settings file the fixed data_3 regression case is run.
+ * --check exits with 1 if the regression case does not end with REGRESSION_CHECKSUM.
+ */
+
+//Includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <vector>
+#include <map>
+#include <memory>
+
+//Custom files
+#include "xlib.h"
+#include "massmovementsimulator.h"
+#include "simulationfactory.h"
+
+using namespace std;
+
+#define REGRESSION_STEPS 200
+#define REGRESSION_SEED 1
+#define REGRESSION_CHECKSUM 0x69a0429d4a6b141bULL		//particleChecksum after REGRESSION_STEPS, the same for any thread count and kernels
+
+//Method designed to set up the data_3 training scenario with fixed settings, so its results can be compared between commits
+void initRegressionCase(MassMovementSimulator &simulator) {
+    string resources = "libs/simulations/avalanche-simulation/resources/";
+    simulator.elevationDEMFile = resources + "training-data/data_3_dem.txt";
+    simulator.terrainColorFile = resources + "normalmap.bmp";
+    simulator.startingZoneFile = resources + "training-data/data_3_startzones.bmp";
+    simulator.flowPathOutputFile = resources + "training-data/data_3_flowpath";
+    simulator.pathFile = resources + "training-data/data_3_path.bmp";
+    simulator.pathDistanceMapFile = resources + "training-data/data_3_pathdistance.bmp";
+
+    simulator.initialHeight = 200;
+    simulator.bounceFriction = 0.025;
+    simulator.stickyness = 0.5;
+    simulator.dampingForce = 0.01;
+    simulator.turbulanceForce = 0.16;
+    simulator.clumpingFactor = 0.5;
+    simulator.viscosity = 0.25;
+    simulator.gridSize = 128;
+    simulator.framesPerSecond = 60;
+    simulator.maxIterations = 2000;
+    simulator.seed = REGRESSION_SEED;
+    initSimulator(simulator);
+}
+
+//Method designed to hash the bits of every particle position and velocity
+unsigned long long particleChecksum(const MassMovementSimulator &simulator) {
+    unsigned long long hash = 14695981039346656037ULL;
+    const float *streams[6] = { simulator.particles.px, simulator.particles.py, simulator.particles.pz,
+        simulator.particles.vx, simulator.particles.vy, simulator.particles.vz };
+    for (int i = 0; i < simulator.particles.size(); i++) {
+        for (int s = 0; s < 6; s++) {
+            unsigned int bits;
+            memcpy(&bits, &streams[s][i], sizeof(bits));
+            hash = (hash ^ bits) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+//Method designed to return the sum of every forceMap pixel
+double forceMapSum(MassMovementSimulator &simulator) {
+    simulator.resolveForceMap();
+    float *force = (float*)simulator.forceMap.getDataSource();
+    double sum = 0;
+    for (int p = 0; p < simulator.forceMap.width() * simulator.forceMap.height(); p++) {
+        sum += force[p];
+    }
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    int steps = REGRESSION_STEPS;
+    int threads = 1;
+    bool useSimd = true;
+    bool check = false;
+    vector<string> files;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--steps" && a + 1 < argc) {
+            steps = atoi(argv[++a]);
+        }
+        else if (arg == "--threads" && a + 1 < argc) {
+            threads = atoi(argv[++a]);
+        }
+        else if (arg == "--scalar") {
+            useSimd = false;
+        }
+        else if (arg == "--check") {
+            check = true;
+        }
+        else if (arg[0] == '-') {
+            cout << "Usage: simulationbenchmark [--steps n] [--threads n] [--scalar] [--check] [datafile settingsfile]" << endl;
+            return 1;
+        }
+        else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != 0 && files.size() != 2) {
+        cout << "ERROR: Expected both a data file and a settings file" << endl;
+        return 1;
+    }
+    if (check && (!files.empty() || steps != REGRESSION_STEPS)) {
+        cout << "ERROR: --check only applies to the regression case at " << REGRESSION_STEPS << " steps" << endl;
+        return 1;
+    }
+
+    MassMovementSimulator simulator;
+    if (files.empty()) {
+        initRegressionCase(simulator);
+    }
+    else {
+        initSimulator(simulator, files[0], files[1]);
+    }
+    simulator.numThreads = threads;
+    if (!files.empty()) {
+        useSimd = useSimd && simulator.useSimd;
+    }
+    simulator.useSimd = useSimd;
+    simulator.profile.enabled = true;
+
+    long long start = SimulationProfile::now();
+    for (int s = 0; s < steps; s++) {
+        simulator.updateAllParticles();
+    }
+    long long elapsed = SimulationProfile::now() - start;
+
+    const SimulationProfile &profile = simulator.profile;
+    printf("scenario   %s\n", files.empty() ? "data_3 regression" : files[0].c_str());
+    printf("particles  %d\n", simulator.particles.size());
+    printf("steps      %d\n", steps);
+    printf("threads    %d\n", simulator.workerCount(simulator.particles.size()));
+    printf("kernels    %s\n", ParticleKernels::select(simulator.useSimd).name);
+    printf("\nphase        ns/particle/step\n");
+    double measured = 0;
+    for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+        double ns = profile.nsPerParticleStep((SimulationPhase)phase);
+        measured += ns;
+        printf("%-12s %10.2f\n", SimulationProfile::name((SimulationPhase)phase), ns);
+    }
+    printf("%-12s %10.2f\n", "total", measured);
+    printf("%-12s %10.2f\n", "wall", profile.particleSteps > 0 ? double(elapsed) / double(profile.particleSteps) : 0.0);
+    printf("\nwall time  %.3f ms\n", elapsed / 1e6);
+    unsigned long long checksum = particleChecksum(simulator);
+    printf("checksum   %016llx\n", checksum);
+    printf("forceMap   %.6f\n", forceMapSum(simulator));
+    printf("sleeping   %d\n", simulator.sleepingParticles());
+    if (check) {
+        if (checksum != REGRESSION_CHECKSUM) {
+            printf("\nFAILED: expected checksum %016llx\n", REGRESSION_CHECKSUM);
+            return 1;
+        }
+        printf("\npassed\n");
+    }
+    return 0;
+}
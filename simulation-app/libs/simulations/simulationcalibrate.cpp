@@ -0,0 +1,84 @@
+/**
+ * simulationcalibrate.cpp
+ * @fileoverview .cpp file designed to fit the physics settings of a simulation to the path images of its data file
+ * @author Unknown
+ * Created: October 17th, 2026
+ *
+ * Usage (from the simulation-app directory):
+ *   simulationcalibrate [--jobs n] [--output settingsfile] datafile settingsfile calibrationfile
+ * See SimulationCalibration::parse() in simulationcalibration.h for the calibration file format.
+ */
+
+//Includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <vector>
+#include <map>
+#include <memory>
+
+//Custom files
+#include "xlib.h"
+#include "massmovementsimulator.h"
+#include "simulationfactory.h"
+#include "simulationbatch.h"
+#include "simulationcalibration.h"
+
+using namespace std;
+
+int main(int argc, char **argv) {
+    SimulationCalibration calibration;
+    string output = "calibrated_settings.txt";
+    vector<string> files;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--jobs" && a + 1 < argc) {
+            calibration.batch.jobs = atoi(argv[++a]);
+        }
+        else if (arg == "--output" && a + 1 < argc) {
+            output = argv[++a];
+        }
+        else if (arg[0] == '-') {
+            cout << "Usage: simulationcalibrate [--jobs n] [--output settingsfile] datafile settingsfile calibrationfile" << endl;
+            return 1;
+        }
+        else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != 3) {
+        cout << "ERROR: Expected a data file, a settings file and a calibration file" << endl;
+        return 1;
+    }
+
+    if (!calibration.parse(files[2]) || !calibration.batch.init(files[0], files[1])) {
+        return 1;
+    }
+    if (!calibration.batch.base.hasPath()) {
+        cout << "ERROR: The data file needs a pathFile and a pathDistanceMap the size of its startingZoneFile" << endl;
+        return 1;
+    }
+
+    long long start = SimulationProfile::now();
+    CalibrationPoint best = calibration.run([&](int iteration, const CalibrationPoint &point) {
+        printf("iteration %3d  pathError %.6f ", iteration, point.error);
+        for (int p = 0; p < (int)calibration.params.size(); p++) {
+            printf(" %s %.6g", calibration.params[p].name.c_str(), calibration.value(point.x, p));
+        }
+        printf("\n");
+        fflush(stdout);
+    });
+    printf("runs       %d (%d abandoned early)\n", calibration.evaluations, calibration.abandoned);
+    printf("wall time  %.1f s\n", (SimulationProfile::now() - start) / 1e9);
+
+    if (!calibration.writeSettings(output, best)) {
+        return 1;
+    }
+    printf("settings   %s\n", output.c_str());
+    return 0;
+}
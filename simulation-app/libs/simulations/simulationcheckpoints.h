@@ -0,0 +1,146 @@
+/**
+ * simulationcheckpoints.h
+ * @fileoverview .h file designed to provide methods to list, restore, save and load checkpoints of a simulation
+ * @author Unknown
+ * Created: October 17th, 2026
+ */
+
+#ifndef SIMULATIONCHECKPOINTS_H
+#define SIMULATIONCHECKPOINTS_H
+
+//Method designed to return {step, checkpointInterval, checkpoints} where checkpoints holds the step of every in memory checkpoint
+void getSimulationCheckpoints(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Array> steps = v8::Array::New(isolate, simulator.checkpoints.size());
+    for (int i = 0; i < simulator.checkpoints.size(); i++) {
+        steps->Set(i, Nan::New(simulator.checkpoints.checkpoints[i].step));
+    }
+
+    v8::Local<v8::Object> result = v8::Object::New(isolate);
+    result->Set(context, v8::String::NewFromUtf8(isolate, "step"), Nan::New(simulator.stepCount));
+    result->Set(context, v8::String::NewFromUtf8(isolate, "checkpointInterval"), Nan::New(simulator.checkpointInterval));
+    result->Set(context, v8::String::NewFromUtf8(isolate, "checkpoints"), steps);
+
+    //Set return
+    info.GetReturnValue().Set(result);
+}
+
+//Method designed to return a simulation to its in memory checkpoint of the given step, returns false if there is none
+void restoreSimulationCheckpoint(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsNumber()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, number step)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+    unsigned int step = (unsigned int)info[1]->NumberValue();
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    MassMovementSimulator &simulator = *simulations[id];
+    bool restored;
+    {
+        std::lock_guard<SimulationLock> guard(simulator.stepLock);
+        restored = simulator.restoreCheckpoint(step);
+    }
+
+    //A scheduled simulation that had stopped at maxIterations continues from the restored step right away
+    if (restored && schedulers.count(id) == 1) {
+        schedulers[id]->wake();
+    }
+
+    //Set return
+    info.GetReturnValue().Set(Nan::New(restored));
+}
+
+//Method designed to write the current state of a simulation to a checkpoint file, returns false if it cannot be written
+void saveSimulationCheckpoint(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, string file)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+    v8::String::Utf8Value param2(info[1]->ToString());
+    string file = string(*param2);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+
+    //Set return
+    info.GetReturnValue().Set(Nan::New(simulator.writeCheckpoint(file)));
+}
+
+//Method designed to continue a simulation from a checkpoint file of the same scenario, returns false if it cannot be used
+void loadSimulationCheckpoint(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, string file)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+    v8::String::Utf8Value param2(info[1]->ToString());
+    string file = string(*param2);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    MassMovementSimulator &simulator = *simulations[id];
+    bool restored;
+    {
+        std::lock_guard<SimulationLock> guard(simulator.stepLock);
+        restored = simulator.readCheckpoint(file);
+    }
+
+    //A scheduled simulation that had stopped at maxIterations continues from the restored step right away
+    if (restored && schedulers.count(id) == 1) {
+        schedulers[id]->wake();
+    }
+
+    //Set return
+    info.GetReturnValue().Set(Nan::New(restored));
+}
+
+#endif
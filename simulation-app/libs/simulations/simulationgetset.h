@@ -31,7 +31,7 @@ void getAllSimulationSettings(const Nan::FunctionCallbackInfo<v8::Value> &info)
     v8::Local<v8::Context> context = v8::Context::New(isolate);
 
     //Build map of properties
-    MassMovementSimulator &simulator = simulations[id];
+    MassMovementSimulator &simulator = *simulations[id];
     v8::Local<v8::Object> simulationSettings = v8::Object::New(isolate);
 
     simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "initialHeight"), Nan::New(simulator.initialHeight)); 
@@ -42,6 +42,17 @@ void getAllSimulationSettings(const Nan::FunctionCallbackInfo<v8::Value> &info)
     simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "clumpingFactor"), Nan::New(simulator.clumpingFactor)); 
     simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "viscosity"), Nan::New(simulator.viscosity)); 
     simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "framesPerSecond"), Nan::New(simulator.framesPerSecond)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "numThreads"), Nan::New(simulator.numThreads)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "useSimd"), Nan::New(simulator.useSimd)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "sleepVelocity"), Nan::New(simulator.sleepVelocity)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "sleepSteps"), Nan::New(simulator.sleepSteps)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "seed"), Nan::New(simulator.seed)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "checkpointInterval"), Nan::New(simulator.checkpointInterval)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "checkpointCount"), Nan::New(simulator.checkpointCount)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "frameBudget"), Nan::New(simulator.frameBudget)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "meshTolerance"), Nan::New(simulator.meshTolerance)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "timeStep"), Nan::New(simulator.timeStep)); 
+    simulationSettings->Set(context, v8::String::NewFromUtf8(isolate, "smoothTerrain"), Nan::New(simulator.smoothTerrain)); 
     
     //Set return
     info.GetReturnValue().Set(simulationSettings);
@@ -65,7 +76,7 @@ void getSimulationInitialHeight(const Nan::FunctionCallbackInfo<v8::Value> &info
     }
 
     //Set return value
-    info.GetReturnValue().Set(Nan::New(simulations[id].initialHeight));
+    info.GetReturnValue().Set(Nan::New(simulations[id]->initialHeight));
 }
 
 //Method designed to set the initial height of the given simulation
@@ -87,7 +98,9 @@ void setSimulationInitialHeight(const Nan::FunctionCallbackInfo<v8::Value> &info
     }
 
     //Set property
-    simulations[id].initialHeight = info[1]->NumberValue();
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.initialHeight = info[1]->NumberValue();
 
     //Set return
     info.GetReturnValue().Set(Nan::New(true));
@@ -111,7 +124,7 @@ void getSimulationBounceFriction(const Nan::FunctionCallbackInfo<v8::Value> &inf
     }
 
     //Set return value
-    info.GetReturnValue().Set(Nan::New(simulations[id].bounceFriction));
+    info.GetReturnValue().Set(Nan::New(simulations[id]->bounceFriction));
 }
 
 //Method designed to set the bounce friction of the given simulation
@@ -133,7 +146,10 @@ void setSimulationBounceFriction(const Nan::FunctionCallbackInfo<v8::Value> &inf
     }
 
     //Set property
-    simulations[id].bounceFriction = info[1]->NumberValue();
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.bounceFriction = info[1]->NumberValue();
+    simulator.wakeParticles();
 
     //Set return
     info.GetReturnValue().Set(Nan::New(true));
@@ -157,7 +173,7 @@ void getSimulationStickyness(const Nan::FunctionCallbackInfo<v8::Value> &info) {
     }
 
     //Set return value
-    info.GetReturnValue().Set(Nan::New(simulations[id].stickyness));
+    info.GetReturnValue().Set(Nan::New(simulations[id]->stickyness));
 }
 
 //Method designed to set the stickyness of the given simulation
@@ -179,7 +195,10 @@ void setSimulationStickyness(const Nan::FunctionCallbackInfo<v8::Value> &info) {
     }
 
     //Set property
-    simulations[id].stickyness = info[1]->NumberValue();
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.stickyness = info[1]->NumberValue();
+    simulator.wakeParticles();
 
     //Set return
     info.GetReturnValue().Set(Nan::New(true));
@@ -203,7 +222,7 @@ void getSimulationDampingForce(const Nan::FunctionCallbackInfo<v8::Value> &info)
     }
 
     //Set return value
-    info.GetReturnValue().Set(Nan::New(simulations[id].dampingForce));
+    info.GetReturnValue().Set(Nan::New(simulations[id]->dampingForce));
 }
 
 //Method designed to set the damping force of the given simulation
@@ -225,7 +244,10 @@ void setSimulationDampingForce(const Nan::FunctionCallbackInfo<v8::Value> &info)
     }
 
     //Set property
-    simulations[id].dampingForce = info[1]->NumberValue();
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.dampingForce = info[1]->NumberValue();
+    simulator.wakeParticles();
 
     //Set return
     info.GetReturnValue().Set(Nan::New(true));
@@ -249,7 +271,7 @@ void getSimulationTurbulanceForce(const Nan::FunctionCallbackInfo<v8::Value> &in
     }
 
     //Set return value
-    info.GetReturnValue().Set(Nan::New(simulations[id].turbulanceForce));
+    info.GetReturnValue().Set(Nan::New(simulations[id]->turbulanceForce));
 }
 
 //Method designed to set the turbulance force of the given simulation
@@ -271,7 +293,10 @@ void setSimulationTurbulanceForce(const Nan::FunctionCallbackInfo<v8::Value> &in
     }
 
     //Set property
-    simulations[id].turbulanceForce = info[1]->NumberValue();
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.turbulanceForce = info[1]->NumberValue();
+    simulator.wakeParticles();
 
     //Set return
     info.GetReturnValue().Set(Nan::New(true));
@@ -295,7 +320,7 @@ void getSimulationClumpingFactor(const Nan::FunctionCallbackInfo<v8::Value> &inf
     }
 
     //Set return value
-    info.GetReturnValue().Set(Nan::New(simulations[id].clumpingFactor));
+    info.GetReturnValue().Set(Nan::New(simulations[id]->clumpingFactor));
 }
 
 //Method designed to set the clumping factor of the given simulation
@@ -317,7 +342,10 @@ void setSimulationClumpingFactor(const Nan::FunctionCallbackInfo<v8::Value> &inf
     }
 
     //Set property
-    simulations[id].clumpingFactor = info[1]->NumberValue();
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.clumpingFactor = info[1]->NumberValue();
+    simulator.wakeParticles();
 
     //Set return
     info.GetReturnValue().Set(Nan::New(true));
@@ -341,7 +369,7 @@ void getSimulationViscosity(const Nan::FunctionCallbackInfo<v8::Value> &info) {
     }
 
     //Set return value
-    info.GetReturnValue().Set(Nan::New(simulations[id].viscosity));
+    info.GetReturnValue().Set(Nan::New(simulations[id]->viscosity));
 }
 
 //Method designed to set the viscosity of the given simulation
@@ -363,7 +391,10 @@ void setSimulationViscosity(const Nan::FunctionCallbackInfo<v8::Value> &info) {
     }
 
     //Set property
-    simulations[id].viscosity = info[1]->NumberValue();
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.viscosity = info[1]->NumberValue();
+    simulator.wakeParticles();
 
     //Set return
     info.GetReturnValue().Set(Nan::New(true));
@@ -387,7 +418,7 @@ void getSimulationFramesPerSecond(const Nan::FunctionCallbackInfo<v8::Value> &in
     }
 
     //Set return value
-    info.GetReturnValue().Set(Nan::New(simulations[id].framesPerSecond));
+    info.GetReturnValue().Set(Nan::New(simulations[id]->framesPerSecond));
 }
 
 //Method designed to set the frames per second of the given simulation
@@ -409,7 +440,201 @@ void setSimulationFramesPerSecond(const Nan::FunctionCallbackInfo<v8::Value> &in
     }
 
     //Set property
-    simulations[id].framesPerSecond = info[1]->NumberValue();
+    MassMovementSimulator &simulator = *simulations[id];
+    {
+        std::lock_guard<SimulationLock> guard(simulator.stepLock);
+        simulator.framesPerSecond = info[1]->NumberValue();
+    }
+
+    //A scheduled simulation switches to the new rate right away
+    if (schedulers.count(id) == 1) {
+        schedulers[id]->wake();
+    }
+
+    //Set return
+    info.GetReturnValue().Set(Nan::New(true));
+}
+
+//Method designed to return the number of threads used to step the given simulation
+void getSimulationNumThreads(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    if (info.Length() != 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch. Function requires (string id)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    //Set return value
+    info.GetReturnValue().Set(Nan::New(simulations[id]->numThreads));
+}
+
+//Method designed to set the number of threads used to step the given simulation
+void setSimulationNumThreads(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsNumber()) {
+        Nan::ThrowTypeError("Parameter Mismatch. Function requires (string id, number newNumThreads)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    //Set property
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.numThreads = xlib::clamp((int)info[1]->NumberValue(), 1, 64);
+
+    //Set return
+    info.GetReturnValue().Set(Nan::New(true));
+}
+
+//Method designed to return the most vertices sent in a display frame of the given simulation, 0 if every particle is sent
+void getSimulationFrameBudget(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    if (info.Length() != 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch. Function requires (string id)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    //Set return value
+    info.GetReturnValue().Set(Nan::New(simulations[id]->frameBudget));
+}
+
+//Method designed to set the most vertices sent in a display frame of the given simulation, 0 sends every particle
+void setSimulationFrameBudget(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsNumber()) {
+        Nan::ThrowTypeError("Parameter Mismatch. Function requires (string id, number newFrameBudget)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    //Set property
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.frameBudget = xlib::clamp((int)info[1]->NumberValue(), 0, 1 << 30);
+
+    //Set return
+    info.GetReturnValue().Set(Nan::New(true));
+}
+
+//Method designed to return the steps between the in memory checkpoints of the given simulation, 0 if none are kept
+void getSimulationCheckpointInterval(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    if (info.Length() != 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch. Function requires (string id)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    //Set return value
+    info.GetReturnValue().Set(Nan::New(simulations[id]->checkpointInterval));
+}
+
+//Method designed to set the steps between the in memory checkpoints of the given simulation
+//0 stops recording and frees the stored checkpoints, so only viewers stepping back pay for them
+void setSimulationCheckpointInterval(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsNumber()) {
+        Nan::ThrowTypeError("Parameter Mismatch. Function requires (string id, number newCheckpointInterval)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    //Set property
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.checkpointInterval = xlib::clamp((int)info[1]->NumberValue(), 0, 1 << 30);
+    if (simulator.checkpointInterval == 0) {
+        simulator.checkpoints = CheckpointRing();
+    }
+
+    //Set return
+    info.GetReturnValue().Set(Nan::New(true));
+}
+
+//Method designed to set the gradient the particles of the given simulation are colored with, from dense to sparse
+//Takes a flat array of r,g,b components in [0, 1] holding at least two colors
+void setSimulationColorMap(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 2 || !info[0]->IsString() || !info[1]->IsArray()) {
+        Nan::ThrowTypeError("Parameter Mismatch. Function requires (string id, array colors)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+    v8::Local<v8::Array> colors = info[1].As<v8::Array>();
+    if (colors->Length() < 6 || colors->Length() % 3 != 0) {
+        Nan::ThrowTypeError("Parameter Mismatch. The colors need r,g,b components for at least two colors");
+        return;
+    }
+    vector<xlib::vec3> gradient;
+    for (unsigned int i = 0; i < colors->Length(); i += 3) {
+        gradient.push_back(xlib::vec3(colors->Get(i)->NumberValue(), colors->Get(i + 1)->NumberValue(), colors->Get(i + 2)->NumberValue()));
+    }
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    //Set property, the next frame is colored with the new gradient
+    MassMovementSimulator &simulator = *simulations[id];
+    std::lock_guard<SimulationLock> guard(simulator.stepLock);
+    simulator.densityColors.build(gradient);
 
     //Set return
     info.GetReturnValue().Set(Nan::New(true));
@@ -19,17 +19,21 @@
 #include <vector>
 #include <map>
 #include <utility>
+#include <memory>
+#include <mutex>
 
 //Custom files
 #include "xlib.h"
 #include "massmovementsimulator.h"
 #include "simulationfactory.h"
+#include "simulationscheduler.h"
 
 using namespace std;
 
-//Simulation and density colors maps
-map<string, MassMovementSimulator> simulations;
-vector<xlib::vec3> particleDensityColor;
+//Simulation maps
+//Simulations are shared so that background steps can outlive a removeSimulation call
+map<string, std::shared_ptr<MassMovementSimulator> > simulations;
+map<string, std::shared_ptr<SimulationScheduler> > schedulers;	//simulations stepped on their own thread, see simulationschedulers.h
 
 //Method designed to log the given string to a log file
 void logToFile(string info) {
@@ -43,7 +47,12 @@ void logToFile(string info) {
 #include "simulationaddremove.h"
 #include "getnextsimulationframe.h"
 #include "getsimulationterraindata.h"
+#include "getsimulationterraintiles.h"
+#include "exportsimulationflowpath.h"
+#include "simulationcheckpoints.h"
 #include "simulationgetset.h"
+#include "simulationasync.h"
+#include "simulationschedulers.h"
 
 //Method designed to initialize the addon
 void Init(v8::Local<v8::Object> exports) { 
@@ -52,8 +61,25 @@ void Init(v8::Local<v8::Object> exports) {
     exports->Set(Nan::New("removeSimulation").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(removeSimulation)->GetFunction());
     exports->Set(Nan::New("getNextSimulationFrame").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getNextSimulationFrame)->GetFunction());
     exports->Set(Nan::New("getNextSimulationFrameFromGrid").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getNextSimulationFrameFromGrid)->GetFunction());
+    exports->Set(Nan::New("getNextEncodedSimulationFrame").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getNextEncodedSimulationFrame)->GetFunction());
+    exports->Set(Nan::New("acknowledgeSimulationFrame").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(acknowledgeSimulationFrame)->GetFunction());
 	exports->Set(Nan::New("skipSimulationFrames").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(skipSimulationFrames)->GetFunction());
+    exports->Set(Nan::New("addSimulationAsync").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(addSimulationAsync)->GetFunction());
+    exports->Set(Nan::New("getNextSimulationFrameAsync").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getNextSimulationFrameAsync)->GetFunction());
+    exports->Set(Nan::New("getNextEncodedSimulationFrameAsync").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getNextEncodedSimulationFrameAsync)->GetFunction());
+    exports->Set(Nan::New("skipSimulationFramesAsync").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(skipSimulationFramesAsync)->GetFunction());
+    exports->Set(Nan::New("startSimulationScheduler").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(startSimulationScheduler)->GetFunction());
+    exports->Set(Nan::New("stopSimulationScheduler").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(stopSimulationScheduler)->GetFunction());
+    exports->Set(Nan::New("getLatestSimulationFrameAsync").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getLatestSimulationFrameAsync)->GetFunction());
     exports->Set(Nan::New("getSimulationTerrainData").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getSimulationTerrainData)->GetFunction());
+    exports->Set(Nan::New("getSimulationTerrainDataAsync").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getSimulationTerrainDataAsync)->GetFunction());
+    exports->Set(Nan::New("getSimulationTerrainTileInfo").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getSimulationTerrainTileInfo)->GetFunction());
+    exports->Set(Nan::New("getSimulationTerrainTile").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getSimulationTerrainTile)->GetFunction());
+    exports->Set(Nan::New("exportSimulationFlowPath").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(exportSimulationFlowPath)->GetFunction());
+    exports->Set(Nan::New("getSimulationCheckpoints").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getSimulationCheckpoints)->GetFunction());
+    exports->Set(Nan::New("restoreSimulationCheckpoint").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(restoreSimulationCheckpoint)->GetFunction());
+    exports->Set(Nan::New("saveSimulationCheckpoint").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(saveSimulationCheckpoint)->GetFunction());
+    exports->Set(Nan::New("loadSimulationCheckpoint").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(loadSimulationCheckpoint)->GetFunction());
     exports->Set(Nan::New("getAllSimulationSettings").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getAllSimulationSettings)->GetFunction());
     exports->Set(Nan::New("getSimulationInitialHeight").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getSimulationInitialHeight)->GetFunction());
     exports->Set(Nan::New("setSimulationInitialHeight").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(setSimulationInitialHeight)->GetFunction());
@@ -71,14 +97,13 @@ void Init(v8::Local<v8::Object> exports) {
     exports->Set(Nan::New("setSimulationViscosity").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(setSimulationViscosity)->GetFunction());
     exports->Set(Nan::New("getSimulationFramesPerSecond").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getSimulationFramesPerSecond)->GetFunction());
     exports->Set(Nan::New("setSimulationFramesPerSecond").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(setSimulationFramesPerSecond)->GetFunction());
-
-    //Init particle density color map
-    particleDensityColor.push_back(xlib::vec3(1.0, 1.0, 1.0));
-    particleDensityColor.push_back(xlib::vec3(1.0, 0.0, 0.0));
-    particleDensityColor.push_back(xlib::vec3(1.0, 1.0, 0.0));
-    particleDensityColor.push_back(xlib::vec3(0.0, 1.0, 0.0));
-    particleDensityColor.push_back(xlib::vec3(0.0, 1.0, 1.0));
-    particleDensityColor.push_back(xlib::vec3(0.0, 0.0, 1.0));
+    exports->Set(Nan::New("getSimulationNumThreads").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getSimulationNumThreads)->GetFunction());
+    exports->Set(Nan::New("setSimulationNumThreads").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(setSimulationNumThreads)->GetFunction());
+    exports->Set(Nan::New("getSimulationFrameBudget").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getSimulationFrameBudget)->GetFunction());
+    exports->Set(Nan::New("setSimulationFrameBudget").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(setSimulationFrameBudget)->GetFunction());
+    exports->Set(Nan::New("getSimulationCheckpointInterval").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(getSimulationCheckpointInterval)->GetFunction());
+    exports->Set(Nan::New("setSimulationCheckpointInterval").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(setSimulationCheckpointInterval)->GetFunction());
+    exports->Set(Nan::New("setSimulationColorMap").ToLocalChecked(), Nan::New<v8::FunctionTemplate>(setSimulationColorMap)->GetFunction());
 }
 
 //Macro
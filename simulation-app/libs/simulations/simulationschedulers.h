@@ -0,0 +1,138 @@
+/**
+ * simulationschedulers.h
+ * @fileoverview .h file designed to provide methods to step simulations on their own thread and read their latest frame
+ * @author Unknown
+ * Created: October 17th, 2026
+ */
+
+#ifndef SIMULATIONSCHEDULERS_H
+#define SIMULATIONSCHEDULERS_H
+
+//Method designed to fill a published frame with every particle of the simulation, used by the schedulers
+void buildPublishedFrame(MassMovementSimulator &simulator, PublishedFrame &frame) {
+    frame.vertexCount = fillSimulationFrame(simulator);
+    frame.vertices.assign(&simulator.frameVertices[0], &simulator.frameVertices[0] + frame.vertexCount * 3);
+    frame.colors.assign(&simulator.frameColors[0], &simulator.frameColors[0] + frame.vertexCount * 3);
+}
+
+//Worker that copies the latest frame published by a scheduler and optionally encodes it
+class LatestFrameWorker : public Nan::AsyncWorker {
+public:
+    //Constructor
+    LatestFrameWorker(Nan::Callback *callback, std::shared_ptr<SimulationScheduler> scheduler, bool encoded)
+        : Nan::AsyncWorker(callback), scheduler(scheduler), encoded(encoded) {
+    }
+
+    //Method run on a thread pool thread, never waits for the simulation to finish a step
+    void Execute() {
+        scheduler->frames.read(frame);
+        if (encoded) {
+            std::lock_guard<std::mutex> guard(scheduler->encoderLock);
+            scheduler->encoder.encode(frame.vertices.data(), frame.colors.data(), frame.vertexCount, frame.low, frame.high, encodedFrame);
+        }
+    }
+
+    //Method run on the main thread once Execute has finished
+    void HandleOKCallback() {
+        Nan::HandleScope scope;
+
+        v8::Local<v8::Value> result;
+        if (encoded) {
+            result = buildEncodedFrameObject(v8::Isolate::GetCurrent(), encodedFrame.data(), encodedFrame.size());
+        }
+        else {
+            result = buildFrameObject(v8::Isolate::GetCurrent(), frame.vertices.data(), frame.colors.data(), frame.vertexCount);
+        }
+
+        v8::Local<v8::Value> argv[] = { Nan::Null(), result };
+        callback->Call(2, argv);
+    }
+
+private:
+    std::shared_ptr<SimulationScheduler> scheduler;
+    bool encoded;
+    PublishedFrame frame;
+    std::vector<unsigned char> encodedFrame;
+};
+
+//Method designed to step the simulation indexed by the given id framesPerSecond times a second on its own thread
+//Returns false if the simulation is already being stepped
+void startSimulationScheduler(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    //Check if the id exists
+    if (simulations.count(id) == 0) {
+        Nan::ThrowTypeError(("No simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    if (schedulers.count(id) == 1) {
+        info.GetReturnValue().Set(Nan::New(false));
+        return;
+    }
+
+    std::shared_ptr<SimulationScheduler> scheduler = std::make_shared<SimulationScheduler>(simulations[id], buildPublishedFrame);
+    scheduler->start();
+    schedulers.emplace(id, scheduler);
+
+    //Set return
+    info.GetReturnValue().Set(Nan::New(true));
+}
+
+//Method designed to stop stepping the simulation indexed by the given id, returns false if it was not being stepped
+void stopSimulationScheduler(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+
+    if (schedulers.count(id) == 0) {
+        info.GetReturnValue().Set(Nan::New(false));
+        return;
+    }
+
+    schedulers[id]->stop();
+    schedulers.erase(id);
+
+    //Set return
+    info.GetReturnValue().Set(Nan::New(true));
+}
+
+//Method designed to read the latest frame of a simulation stepped by startSimulationScheduler without blocking the main thread
+//Takes (string id, boolean encoded, function callback), the callback receives the same objects as the getNext*Async functions
+void getLatestSimulationFrameAsync(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+    //Params checking
+    if (info.Length() != 3 || !info[0]->IsString() || !info[1]->IsBoolean() || !info[2]->IsFunction()) {
+        Nan::ThrowTypeError("Parameter Mismatch: Function requires (string id, boolean encoded, function callback)");
+        return;
+    }
+
+    //Extract params
+    v8::String::Utf8Value param1(info[0]->ToString());
+    string id = string(*param1);
+    bool encoded = info[1]->BooleanValue();
+
+    //Check if the simulation is being stepped
+    if (schedulers.count(id) == 0) {
+        Nan::ThrowTypeError(("No scheduled simulation with id: " + id + " exists").c_str());
+        return;
+    }
+
+    Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
+    Nan::AsyncQueueWorker(new LatestFrameWorker(callback, schedulers[id], encoded));
+}
+
+#endif
@@ -115,6 +115,7 @@ namespace xlib {
 		//ximage constructors
 		ximage();
 		ximage(const ximage &other);
+		ximage(ximage &&other);
 		ximage(int imageWidth, int imageHeight, int imageDepth = 1, int storageFormat = XIMAGE_FORMAT_RGBA32);
 		ximage(void* pixelData, int pixelStorageFormat, int width, int height, int depth = 1);
 		ximage(string filename, int fileformat);
@@ -182,6 +183,7 @@ namespace xlib {
 		ximage  operator / (const vec4 &v) const;
 
 		ximage & operator =  (const ximage &other);
+		ximage & operator =  (ximage &&other);
 		ximage & operator -= (const ximage &other);
 		ximage & operator += (const ximage &other);
 		ximage & operator *= (const ximage &other);
@@ -424,6 +426,7 @@ namespace xlib {
 		_pixelFormat = XIMAGE_FORMAT_RGBA32;
 		_imageData = NULL;
 		_imageDataSize = 0;
+		_imageDataNotOwned = false;
 	}
 	int ximage::width() const {
 		return _width;
@@ -927,6 +930,7 @@ namespace xlib {
 	}
 	//image operators
 	ximage::ximage(const ximage &other) {
+		_imageDataNotOwned = false;
 		_width = other._width;
 		_height = other._height;
 		_depth = other._depth;
@@ -939,6 +943,7 @@ namespace xlib {
 	ximage & ximage::operator = (const ximage &other) {
 		if (&other == this) return *this;
 		clear();
+		_imageDataNotOwned = false;
 		_width = other._width;
 		_height = other._height;
 		_depth = other._depth;
@@ -949,6 +954,31 @@ namespace xlib {
 		_pixelDecompFuncs = other._pixelDecompFuncs;
 		return *this;
 	}
+	ximage::ximage(ximage &&other) {
+		_width = other._width;
+		_height = other._height;
+		_depth = other._depth;
+		_pixelFormat = other._pixelFormat;
+		_imageDataSize = other._imageDataSize;
+		_imageDataNotOwned = other._imageDataNotOwned;
+		_imageData = other._imageData;
+		_pixelDecompFuncs = other._pixelDecompFuncs;
+		other._init();
+	}
+	ximage & ximage::operator = (ximage &&other) {
+		if (&other == this) return *this;
+		if (!_imageDataNotOwned) clear();
+		_width = other._width;
+		_height = other._height;
+		_depth = other._depth;
+		_pixelFormat = other._pixelFormat;
+		_imageDataSize = other._imageDataSize;
+		_imageDataNotOwned = other._imageDataNotOwned;
+		_imageData = other._imageData;
+		_pixelDecompFuncs = other._pixelDecompFuncs;
+		other._init();
+		return *this;
+	}
 	ximage  ximage::operator - (const ximage &other) const {
 		int maxWidth = MAX(other._width, _width);
 		int maxHeight = MAX(other._height, _height);
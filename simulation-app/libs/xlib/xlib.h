@@ -2,6 +2,7 @@
 #define XLIB_H
 
 #include "xmath.h"
+#include "xrandom.h"
 #include "xarray.h"
 #include "xvector.h"
 #include "ximage.h"
@@ -26,7 +26,8 @@ var app = new Vue({
         clumpingFactor: 0,
         viscosity: 0.0,
         gridSize: 128,
-        framesPerSecond: 10
+        framesPerSecond: 10,
+        checkpointInterval: 0
     },
 
     //Functionality
@@ -60,6 +61,15 @@ var app = new Vue({
         showError: function(msg, title = null) {
             toastr.error(msg, title);
         }, 
+        //Used to turn the in memory checkpoints on, one every simulated second, or off
+        toggleCheckpoints: function() {
+            this.checkpointInterval = this.checkpointInterval > 0 ? 0 : Math.round(this.framesPerSecond);
+            socket.emit("checkpoint interval changed", {value: this.checkpointInterval});
+        },
+        //Used to move the simulation back (offset < 0) or forward (offset > 0) to one of its checkpoints
+        restoreCheckpoint: function(offset) {
+            socket.emit("restore checkpoint", {value: offset});
+        },
         //Used to reset the current simulation TODO: fix loading issue on first reset
         resetSimulation: function() {
             var selectdata = document.getElementById("select-data");
@@ -67,12 +77,18 @@ var app = new Vue({
             
             toastr.success("reseting simulation", null);
             socket.emit("reset simulation", {});  
+            resetFrameDecoder();
+            
+            // keep recording checkpoints in the new simulation, a new settings file replaces the interval below
+            if(this.checkpointInterval > 0) {
+                socket.emit("checkpoint interval changed", {value: this.checkpointInterval});
+            }
             
             // check if a new data file has been selected
             if(lastLoadedData !== selectdata.options[selectdata.selectedIndex].dataset.datafile) {
                 this.showInfo("Requesting Terrain");
                 lastLoadedData = selectdata.options[selectdata.selectedIndex].dataset.datafile
-                requestTerrainData();
+                requestTerrainInfo();
             }
             
             // check if a new settings file has been selected
@@ -100,13 +116,21 @@ var app = new Vue({
                 app.viscosity = data["viscosity"];
                 //app.gridSize = data["gridSize"];
                 app.framesPerSecond = data["framesPerSecond"];
+                app.checkpointInterval = data["checkpointInterval"];
                 app.showSuccess("Initial Settings Loaded");
             });
 
-            socket.on("receive terrain data", function(data) {           
-                terrainData = data;
+            //The terrain is drawn from the root tile as soon as it arrives, finer tiles are streamed while rendering
+            socket.on("receive terrain info", function(data) {
+                if(!gl) {
+                    setUpWebgl();
+                }
+                resetTerrainTiles(data);
                 app.showSuccess("Terrain Loaded");
-                setUpWebgl();
+            });
+
+            socket.on("receive terrain tile", function(data) {
+                receiveTerrainTile(data);
             });
 
             socket.on("receive next frame", function(data) {          
@@ -117,6 +141,20 @@ var app = new Vue({
                 nextFrameReady = true;
             });
 
+            socket.on("receive next encoded frame", function(data) {
+                recTime = new Date();
+
+                //A delta against a keyframe that was dropped (e.g. across a reset) is skipped
+                var frame = decodeFrame(data);
+                if(frame !== null) {
+                    if(frame.isKeyframe) {
+                        socket.emit("acknowledge frame", {value: frame.frame});
+                    }
+                    nextFrame = frame;
+                }
+                nextFrameReady = true;
+            });
+
             socket.on("property updated", function(data) {
                 app.showSuccess(data.message);
             });
@@ -128,7 +166,7 @@ var app = new Vue({
             await sleep(2000);
             //TODO add message
             this.showInfo("Requesting Terrain");
-            requestTerrainData();
+            requestTerrainInfo();
 
         } catch(err) {
             this.showError("Cannot connect to server", "ERROR");
@@ -150,9 +188,9 @@ function requestAllSettings() {
     socket.emit("request all settings", {});
 }
 
-//Method designed to request the terrain data
-function requestTerrainData() {
-    socket.emit("request terrain data", {});
+//Method designed to request the layout of the terrain tiles, the tiles themselves are requested by drawTerrainTiles
+function requestTerrainInfo() {
+    socket.emit("request terrain info", {});
 }
 
 // Used to changed the selected data file
@@ -167,18 +205,12 @@ function changeSettingsFile(select) {
     socket.emit("receive settings file", {value: select.options[select.selectedIndex].dataset.settingsfile});
 }
 
-// Used to drop the given number of frames
-function dropFrames(steps) {
-    //console.log("dropping " + Math.floor(steps) + " frames");
-    socket.emit("drop frames", {value: Math.floor(steps)});
-}
-
 //Method designed to request the next frame
 function requestNextFrame() {
     reqTime = new Date();
     
     nextFrameReady = false;
-    socket.emit("request next frame", {});
+    socket.emit("request next frame", {encoded: true});
 }
 
 //Method designed to sleep for the given time in milliseconds
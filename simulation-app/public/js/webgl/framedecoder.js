@@ -0,0 +1,84 @@
+/**
+ * framedecoder.js
+ * @fileoverview Script used to decode the encoded simulation frames built by frameencoder.h
+ * @author Unknown
+ * Created: October 17th, 2026
+ */
+
+var FRAME_HEADER_BYTES = 40;
+var FRAME_KEPT_KEYFRAMES = 3; //deltas may still refer to an older keyframe until the server has seen the ack of a newer one
+
+//Last keyframes received from the server indexed by frame number, oldest first in frameKeyframeOrder
+var frameKeyframes = {};
+var frameKeyframeOrder = [];
+
+//Method designed to forget every keyframe, used when the simulation is reset
+function resetFrameDecoder() {
+    frameKeyframes = {};
+    frameKeyframeOrder = [];
+}
+
+//Method designed to decode an encoded frame into {vertices, colors, vertexCount, frame, keyframe, isKeyframe}
+//Returns null if the frame is a delta against a keyframe that was never received
+function decodeFrame(data) {
+    //The typed array views below need a buffer that starts on a 4 byte boundary
+    var buffer = data;
+    if (ArrayBuffer.isView(data)) {
+        buffer = data.buffer.slice(data.byteOffset, data.byteOffset + data.byteLength);
+    }
+
+    var header = new Uint32Array(buffer, 0, 4);
+    var box = new Float32Array(buffer, 16, 6);
+    var frame = header[0];
+    var keyframe = header[1];
+    var vertexCount = header[2];
+    var changedCount = header[3];
+    var isKeyframe = frame === keyframe;
+
+    var offset = FRAME_HEADER_BYTES;
+    var indices = null;
+    if (!isKeyframe) {
+        indices = new Uint32Array(buffer, offset, changedCount);
+        offset += changedCount * 4;
+    }
+    var positions = new Uint16Array(buffer, offset, changedCount * 3);
+    offset += (changedCount * 6 + 3) & ~3;
+    var colors = new Uint8Array(buffer, offset, changedCount * 3);
+
+    var base = frameKeyframes[keyframe];
+    if (!isKeyframe && (!base || base.vertexCount !== vertexCount)) {
+        return null;
+    }
+
+    var outVertices = isKeyframe ? new Float32Array(vertexCount * 3) : base.vertices.slice();
+    var outColors = isKeyframe ? new Uint8Array(vertexCount * 3) : base.colors.slice();
+    for (var c = 0; c < changedCount; c++) {
+        var v = isKeyframe ? c : indices[c];
+        for (var k = 0; k < 3; k++) {
+            outVertices[v * 3 + k] = box[k] + positions[c * 3 + k] * box[3 + k];
+            outColors[v * 3 + k] = colors[c * 3 + k];
+        }
+    }
+
+    var decoded = {
+        vertices: outVertices,
+        colors: outColors,
+        vertexCount: vertexCount,
+        frame: frame,
+        keyframe: keyframe,
+        isKeyframe: isKeyframe
+    };
+
+    if (isKeyframe) {
+        var index = frameKeyframeOrder.indexOf(frame);
+        if (index >= 0) {
+            frameKeyframeOrder.splice(index, 1);
+        }
+        frameKeyframeOrder.push(frame);
+        frameKeyframes[frame] = {vertices: outVertices.slice(), colors: outColors.slice(), vertexCount: vertexCount};
+        while (frameKeyframeOrder.length > FRAME_KEPT_KEYFRAMES) {
+            delete frameKeyframes[frameKeyframeOrder.shift()];
+        }
+    }
+    return decoded;
+}
@@ -1,6 +1,5 @@
 var nextFrame; //Next render frame
 var currentFrame; //Current render frame
-var terrainData; //Terrain vertices and texture coordinates
 var lastRender = new Date();
 var lastFrameReq = new Date();
 
@@ -20,14 +19,11 @@ var particleModelMatrixLocation;
 var particleViewMatrixLocation;
 var particleProjectionMatrixLocation;
 
-//Buffers
-var terrainVertexBuffer;
-var terrainTextureBuffer;
+//Buffers, every terrain tile has its own, see terraintiles.js
 var particleVertexBuffer;
 var particleColorBuffer;
 
 //Vertex Array Objects
-var terrainVAO;
 var particleVAO;
 
 //Matrices
@@ -52,17 +48,14 @@ function tick() {
     //timing
     timer += timeElapsed  
     
-    // check if a new frame needs to be requested 
+    // check if a new frame needs to be requested, the server keeps stepping at framesPerSecond in between
     if (timeElapsed > app.timePerFrame && nextFrameReady) {       
         
         if(timer >= 250) {
             fpsElement.innerHTML = Math.ceil(1/(timeElapsed * 0.001));  
             timer = 0;
         }
-        var steps = timeElapsed / app.timePerFrame;
-        if(steps > 10) steps = 10;
         
-        dropFrames(steps);
         currentFrame = nextFrame;
         requestNextFrame();
         
@@ -90,24 +83,23 @@ function render() {
 	gl.uniformMatrix4fv(particleViewMatrixLocation, false, flatten(camera.mat_view));
 	gl.uniformMatrix4fv(particleProjectionMatrixLocation, false, flatten(camera.mat_proj));
 
+	//Frames arrive as binary buffers of packed x,y,z floats and r,g,b bytes
 	gl.bindBuffer(gl.ARRAY_BUFFER, particleVertexBuffer);
-	gl.bufferData(gl.ARRAY_BUFFER, flatten(currentFrame["vertices"]), gl.STATIC_DRAW);
+	gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(currentFrame["vertices"]), gl.STREAM_DRAW);
 
 	gl.bindBuffer(gl.ARRAY_BUFFER, particleColorBuffer);
-	gl.bufferData(gl.ARRAY_BUFFER, flatten(currentFrame["colors"]), gl.STATIC_DRAW);
+	gl.bufferData(gl.ARRAY_BUFFER, new Uint8Array(currentFrame["colors"]), gl.STREAM_DRAW);
 
-	gl.drawArrays(gl.POINTS, 0, currentFrame["colors"].length);
+	gl.drawArrays(gl.POINTS, 0, currentFrame["vertexCount"]);
 
-    //Draw the terrain
+    //Draw the terrain tiles loaded so far
     gl.useProgram(terrainProgram);
-	gl.bindVertexArray(terrainVAO);
 
 	gl.uniformMatrix4fv(terrainModelMatrixLocation, false, flatten(modelMatrix));
 	gl.uniformMatrix4fv(terrainViewMatrixLocation, false, flatten(camera.mat_view));
 	gl.uniformMatrix4fv(terrainProjectionMatrixLocation, false, flatten(camera.mat_proj));
 
-	gl.bindBuffer(gl.ARRAY_BUFFER, terrainVertexBuffer);
-	gl.drawArrays(gl.TRIANGLES, 0, terrainData["vertices"].length);
+	drawTerrainTiles();
 
     lastRender = new Date();
 }
@@ -150,25 +142,13 @@ function setUpWebgl() {
 	particleViewMatrixLocation = gl.getUniformLocation(particleProgram, "viewMatrix");
 	particleProjectionMatrixLocation = gl.getUniformLocation(particleProgram, "projectionMatrix");
 
-    //VAOs
-    terrainVAO = gl.createVertexArray();
+    //VAOs, the terrain tiles are uploaded as they arrive, see receiveTerrainTile
     particleVAO = gl.createVertexArray();
 
     //Buffers
-    terrainVertexBuffer = gl.createBuffer();
-    terrainTextureBuffer = gl.createBuffer();
     particleVertexBuffer = gl.createBuffer();
     particleColorBuffer = gl.createBuffer();
 
-    //Terrain position
-    gl.bindVertexArray(terrainVAO);
-    gl.bindBuffer(gl.ARRAY_BUFFER, terrainVertexBuffer);
-
-    var terrainPosAttrib = gl.getAttribLocation(terrainProgram, "position");
-	gl.enableVertexAttribArray(terrainPosAttrib);
-    gl.vertexAttribPointer(terrainPosAttrib, 3, gl.FLOAT, false, 0, 0);
-    gl.bufferData(gl.ARRAY_BUFFER, flatten(terrainData["vertices"]), gl.STATIC_DRAW); //Send terrain data
-
     //Particle position
     gl.bindVertexArray(particleVAO);
     gl.bindBuffer(gl.ARRAY_BUFFER, particleVertexBuffer);
@@ -183,18 +163,11 @@ function setUpWebgl() {
 
 	var particleColAttrib = gl.getAttribLocation(particleProgram, "color");
 	gl.enableVertexAttribArray(particleColAttrib);
-	gl.vertexAttribPointer(particleColAttrib, 3, gl.FLOAT, false, 0, 0);
+	gl.vertexAttribPointer(particleColAttrib, 3, gl.UNSIGNED_BYTE, true, 0, 0);
 
     //TODO the texture appears to be mapping backwards
     //Terrain texture
     gl.useProgram(terrainProgram);
-    gl.bindVertexArray(terrainVAO);
-    gl.bindBuffer(gl.ARRAY_BUFFER, terrainTextureBuffer);
-
-    var terrainTexAttrib = gl.getAttribLocation(terrainProgram, "uvCoord");
-	gl.enableVertexAttribArray(terrainTexAttrib);
-    gl.vertexAttribPointer(terrainTexAttrib, 2, gl.FLOAT, false, 0, 0);
-    gl.bufferData(gl.ARRAY_BUFFER, flatten(terrainData["textureCoordinates"]), gl.STATIC_DRAW); //Send terrain data
 
     var image = document.getElementById("texImage");
 
@@ -0,0 +1,154 @@
+/**
+ * terraintiles.js
+ * @fileoverview Script used to stream and draw the terrain as the quadtree of tiles built by terraintiles.h
+ * @author Unknown
+ * Created: October 17th, 2026
+ */
+
+var TERRAIN_TILE_PIXELS = 4; //a tile is replaced by its children once the spacing of its vertices covers more pixels on screen
+var TERRAIN_TILE_REQUESTS = 4; //tiles requested from the server at the same time
+
+var terrainInfo = null; //{levels, tileCells, cellSize, rows, columns, tilesX, tilesZ} of the current terrain
+var terrainTiles = {}; //loaded tiles indexed by "level/x/z"
+var terrainTileRequests = {}; //keys of the tiles requested but not received yet
+var terrainTileRequestCount = 0;
+
+//Method designed to forget every tile and start streaming the terrain described by info, used when the terrain changes
+function resetTerrainTiles(info) {
+    for (var key in terrainTiles) {
+        deleteTerrainTile(terrainTiles[key]);
+    }
+    terrainInfo = info;
+    terrainTiles = {};
+    terrainTileRequests = {};
+    terrainTileRequestCount = 0;
+}
+
+//Method designed to upload a tile received from the server, tiles of a previous terrain are ignored
+function receiveTerrainTile(data) {
+    var key = terrainTileKey(data["level"], data["x"], data["z"]);
+    if (!(key in terrainTileRequests)) {
+        return;
+    }
+    delete terrainTileRequests[key];
+    terrainTileRequestCount--;
+
+    var tile = {indexCount: data["indexCount"]};
+    tile.vao = gl.createVertexArray();
+    gl.bindVertexArray(tile.vao);
+
+    tile.positionBuffer = gl.createBuffer();
+    gl.bindBuffer(gl.ARRAY_BUFFER, tile.positionBuffer);
+    var positionAttrib = gl.getAttribLocation(terrainProgram, "position");
+    gl.enableVertexAttribArray(positionAttrib);
+    gl.vertexAttribPointer(positionAttrib, 3, gl.FLOAT, false, 0, 0);
+    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(data["positions"]), gl.STATIC_DRAW);
+
+    tile.textureBuffer = gl.createBuffer();
+    gl.bindBuffer(gl.ARRAY_BUFFER, tile.textureBuffer);
+    var textureAttrib = gl.getAttribLocation(terrainProgram, "uvCoord");
+    gl.enableVertexAttribArray(textureAttrib);
+    gl.vertexAttribPointer(textureAttrib, 2, gl.FLOAT, false, 0, 0);
+    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(data["textureCoordinates"]), gl.STATIC_DRAW);
+
+    tile.indexBuffer = gl.createBuffer();
+    gl.bindBuffer(gl.ELEMENT_ARRAY_BUFFER, tile.indexBuffer);
+    gl.bufferData(gl.ELEMENT_ARRAY_BUFFER, new Uint16Array(data["indices"]), gl.STATIC_DRAW);
+
+    gl.bindVertexArray(null);
+    terrainTiles[key] = tile;
+}
+
+//Method designed to draw the terrain with the terrain program in use and its matrices set
+//Walks the quadtree from the root, refining tiles that are too coarse for their distance to the camera. A tile keeps being
+//drawn until all of its children arrived, and the missing tiles are requested nearest first.
+function drawTerrainTiles() {
+    if (terrainInfo === null) {
+        return;
+    }
+
+    var wanted = [];
+    drawTerrainTile(0, 0, 0, wanted);
+    wanted.sort(function(a, b) {
+        return a.distance - b.distance;
+    });
+    for (var i = 0; i < wanted.length && terrainTileRequestCount < TERRAIN_TILE_REQUESTS; i++) {
+        var key = terrainTileKey(wanted[i].level, wanted[i].x, wanted[i].z);
+        if (!(key in terrainTileRequests)) {
+            terrainTileRequests[key] = true;
+            terrainTileRequestCount++;
+            socket.emit("request terrain tile", {level: wanted[i].level, x: wanted[i].x, z: wanted[i].z});
+        }
+    }
+}
+
+//Method designed to draw a tile or its children, adding the tiles that still have to be loaded to wanted
+function drawTerrainTile(level, x, z, wanted) {
+    var tile = terrainTiles[terrainTileKey(level, x, z)];
+    var distance = terrainTileDistance(level, x, z);
+    if (tile === undefined) {
+        wanted.push({level: level, x: x, z: z, distance: distance});
+        return;
+    }
+
+    if (level + 1 < terrainInfo["levels"] && terrainTileSpacing(level, distance) > TERRAIN_TILE_PIXELS) {
+        var children = [];
+        var loaded = true;
+        for (var cz = 2 * z; cz < Math.min(2 * z + 2, terrainInfo["tilesZ"][level + 1]); cz++) {
+            for (var cx = 2 * x; cx < Math.min(2 * x + 2, terrainInfo["tilesX"][level + 1]); cx++) {
+                children.push([cx, cz]);
+                if (terrainTiles[terrainTileKey(level + 1, cx, cz)] === undefined) {
+                    wanted.push({level: level + 1, x: cx, z: cz, distance: terrainTileDistance(level + 1, cx, cz)});
+                    loaded = false;
+                }
+            }
+        }
+        if (loaded) {
+            for (var i = 0; i < children.length; i++) {
+                drawTerrainTile(level + 1, children[i][0], children[i][1], wanted);
+            }
+            return;
+        }
+    }
+
+    gl.bindVertexArray(tile.vao);
+    gl.drawElements(gl.TRIANGLES, tile.indexCount, gl.UNSIGNED_SHORT, 0);
+}
+
+//Method designed to return the distance from the camera to the closest point of the bounding sphere of a tile
+//The tile is taken to lie at height 0, the heights are only known once it is loaded
+function terrainTileDistance(level, x, z) {
+    var span = terrainTileSpan(level);
+    var low = [x * span, z * span];
+    var high = [Math.min((x + 1) * span, terrainInfo["columns"] - 1), Math.min((z + 1) * span, terrainInfo["rows"] - 1)];
+    var center = mult(modelMatrix, vec4((low[0] + high[0]) * 0.5 * terrainInfo["cellSize"], 0.0, (low[1] + high[1]) * 0.5 * terrainInfo["cellSize"], 1.0));
+    var corner = mult(modelMatrix, vec4(low[0] * terrainInfo["cellSize"], 0.0, low[1] * terrainInfo["cellSize"], 1.0));
+    var radius = length(subtract(vec3(corner[0], corner[1], corner[2]), vec3(center[0], center[1], center[2])));
+    var distance = length(subtract(vec3(center[0], center[1], center[2]), camera.vec_eye)) - radius;
+    return Math.max(distance, 0.001);
+}
+
+//Method designed to return the number of pixels between neighbouring vertices of a level seen at a distance
+function terrainTileSpacing(level, distance) {
+    var step = mult(modelMatrix, vec4(terrainTileSpan(level) / terrainInfo["tileCells"] * terrainInfo["cellSize"], 0.0, 0.0, 0.0));
+    var spacing = length(vec3(step[0], step[1], step[2]));
+    return spacing * gl.drawingBufferHeight / (2.0 * distance * Math.tan(radians(camera.prop_fovY) * 0.5));
+}
+
+//Method designed to return the number of heightMap cells along each side of a tile of a level
+function terrainTileSpan(level) {
+    return terrainInfo["tileCells"] << (terrainInfo["levels"] - 1 - level);
+}
+
+//Method designed to return the key of a tile in terrainTiles
+function terrainTileKey(level, x, z) {
+    return level + "/" + x + "/" + z;
+}
+
+//Method designed to free the buffers of a tile
+function deleteTerrainTile(tile) {
+    gl.deleteBuffer(tile.positionBuffer);
+    gl.deleteBuffer(tile.textureBuffer);
+    gl.deleteBuffer(tile.indexBuffer);
+    gl.deleteVertexArray(tile.vao);
+}
@@ -17,6 +17,11 @@ var simulationManager = require("./build/Release/simulationmanager"); //Custom C
 //Global Vars
 var connections = []; //List of socket connections
 
+//Promise returning versions of the functions that run off the main thread
+var addSimulationAsync = promisify(simulationManager.addSimulationAsync);
+var getLatestSimulationFrameAsync = promisify(simulationManager.getLatestSimulationFrameAsync);
+var getSimulationTerrainDataAsync = promisify(simulationManager.getSimulationTerrainDataAsync);
+
 //View Engine
 app.set("view engine", "ejs");
 app.set("views", path.join(__dirname, "views"));
@@ -41,8 +46,19 @@ io.sockets.on("connection", function(socket) {
     console.log("connected: %s sockets connected", connections.length);
     var datafile = "libs/simulations/avalanche-simulation/resources/simdata.txt";
     var settingsfile = "libs/simulations/avalanche-simulation/resources/simsettings.txt";
+
+    //Simulation work of this socket runs in order, one job after the other
+    var pending = Promise.resolve();
+    function queue(job) {
+        pending = pending.then(job).catch(function(err) {
+            console.log("simulation %s: %s", socket.id, err.message);
+        });
+        return pending;
+    }
      
-    startSimulation(socket.id, datafile, settingsfile);
+    queue(function() {
+        return startSimulation(socket.id, datafile, settingsfile);
+    });
     
     socket.on("receive data file", function(data) {
         console.log("new data file: " + data.value);
@@ -55,89 +71,213 @@ io.sockets.on("connection", function(socket) {
     });
     
     socket.on("reset simulation", function(data) {
-        simulationManager.removeSimulation(socket.id);
-        startSimulation(socket.id, datafile, settingsfile);
+        queue(function() {
+            simulationManager.removeSimulation(socket.id);
+            return startSimulation(socket.id, datafile, settingsfile);
+        });
     });
     
     socket.on("request all settings", function(data) {
-        socket.emit(
-            "receive all settings", 
-            simulationManager.getAllSimulationSettings(socket.id)
-        );
+        queue(function() {
+            socket.emit(
+                "receive all settings", 
+                simulationManager.getAllSimulationSettings(socket.id)
+            );
+        });
     });
 
+    //A simplified terrain is built on a thread pool thread the first time and cached afterwards
     socket.on("request terrain data", function(data) {
-        socket.emit(
-            "receive terrain data", 
-            simulationManager.getSimulationTerrainData(socket.id)
-        );
+        queue(function() {
+            return getSimulationTerrainDataAsync(socket.id).then(function(terrainData) {
+                socket.emit("receive terrain data", terrainData);
+            });
+        });
+    });
+    
+    //The terrain can also be streamed as a quadtree of tiles, the client asks for the tiles it needs in view order
+    socket.on("request terrain info", function(data) {
+        queue(function() {
+            socket.emit(
+                "receive terrain info",
+                simulationManager.getSimulationTerrainTileInfo(socket.id)
+            );
+        });
+    });
+
+    socket.on("request terrain tile", function(data) {
+        queue(function() {
+            var tile = simulationManager.getSimulationTerrainTile(socket.id, data.level, data.x, data.z);
+            if(tile !== null) {
+                socket.emit("receive terrain tile", tile);
+            }
+        });
     });
     
-    socket.on("drop frames", function(data) {
-        if(data.value && data.value > 0) {
-            simulationManager.skipSimulationFrames(socket.id, data.value);
-        }
+    socket.on("export flow path", function(data) {
+        queue(function() {
+            simulationManager.exportSimulationFlowPath(socket.id);
+            socket.emit("property updated", {message: "Flow path exported successfully"});
+        });
+    });
+
+    //Moves back (value < 0) or forward (value > 0) to an in memory checkpoint of the simulation
+    //Going back skips the checkpoint of the last interval so that repeated presses keep going back while frames are stepped
+    socket.on("restore checkpoint", function(data) {
+        queue(function() {
+            var info = simulationManager.getSimulationCheckpoints(socket.id);
+            var target = -1;
+            info.checkpoints.forEach(function(step) {
+                if(data.value < 0 && step + info.checkpointInterval <= info.step) {
+                    target = step;
+                }
+                else if(data.value > 0 && step > info.step && target < 0) {
+                    target = step;
+                }
+            });
+            if(target >= 0 && simulationManager.restoreSimulationCheckpoint(socket.id, target)) {
+                //the checkpoint brings back the settings behind the sliders as well
+                socket.emit("receive all settings", simulationManager.getAllSimulationSettings(socket.id));
+                socket.emit("property updated", {message: "Returned to step " + target});
+            }
+            else {
+                socket.emit("property updated", {message: "No checkpoint to return to"});
+            }
+        });
     });
 
+    //The simulation steps itself at its framesPerSecond until maxIterations, a request returns the latest published frame
+    //and asks for the next one, so a slow client skips frames instead of slowing the simulation down
     socket.on("request next frame", function(data) {
-        socket.emit(
-            "receive next frame", 
-            //simulationManager.getNextSimulationFrameFromGrid(socket.id)
-            simulationManager.getNextSimulationFrame(socket.id)
-        );
+        queue(function() {
+            //Encoded frames are quantized keyframes and deltas, see frameencoder.h
+            var encoded = Boolean(data && data.encoded);
+            return getLatestSimulationFrameAsync(socket.id, encoded).then(function(frame) {
+                socket.emit(encoded ? "receive next encoded frame" : "receive next frame", frame);
+            });
+        });
+    });
+
+    socket.on("acknowledge frame", function(data) {
+        queue(function() {
+            simulationManager.acknowledgeSimulationFrame(socket.id, data.value);
+        });
     });
     
     socket.on("initial height changed", function(data) {
-        simulationManager.setSimulationInitialHeight(socket.id, data.value);
-        socket.emit("property updated", {message: "Initial Height updated successfully"});
+        queue(function() {
+            simulationManager.setSimulationInitialHeight(socket.id, data.value);
+            socket.emit("property updated", {message: "Initial Height updated successfully"});
+        });
     });
 
     socket.on("bounce friction changed", function(data) {
-        simulationManager.setSimulationBounceFriction(socket.id, data.value);
-        socket.emit("property updated", {message: "Bounce Friction updated successfully"});
+        queue(function() {
+            simulationManager.setSimulationBounceFriction(socket.id, data.value);
+            socket.emit("property updated", {message: "Bounce Friction updated successfully"});
+        });
     });
 
     socket.on("stickyness changed", function(data) {
-        simulationManager.setSimulationStickyness(socket.id, data.value);
-        socket.emit("property updated", {message: "Stickiness updated successfully"});
+        queue(function() {
+            simulationManager.setSimulationStickyness(socket.id, data.value);
+            socket.emit("property updated", {message: "Stickiness updated successfully"});
+        });
     });
 
     socket.on("damping force changed", function(data) {
-        simulationManager.setSimulationDampingForce(socket.id, data.value);
-        socket.emit("property updated", {message: "Damping Force updated successfully"});
+        queue(function() {
+            simulationManager.setSimulationDampingForce(socket.id, data.value);
+            socket.emit("property updated", {message: "Damping Force updated successfully"});
+        });
     });
 
     socket.on("turbulance force changed", function(data) {
-        simulationManager.setSimulationTurbulanceForce(socket.id, data.value);
-        socket.emit("property updated", {message: "Turbulance Force updated successfully"});
+        queue(function() {
+            simulationManager.setSimulationTurbulanceForce(socket.id, data.value);
+            socket.emit("property updated", {message: "Turbulance Force updated successfully"});
+        });
     });
 
     socket.on("clumping factor changed", function(data) {
-        simulationManager.setSimulationClumpingFactor(socket.id, data.value);
-        socket.emit("property updated", {message: "Clumping Factor updated successfully"});
+        queue(function() {
+            simulationManager.setSimulationClumpingFactor(socket.id, data.value);
+            socket.emit("property updated", {message: "Clumping Factor updated successfully"});
+        });
     });
 
     socket.on("viscosity changed", function(data) {
-        simulationManager.setSimulationViscosity(socket.id, data.value);
-        socket.emit("property updated", {message: "Viscosity updated successfully"});
+        queue(function() {
+            simulationManager.setSimulationViscosity(socket.id, data.value);
+            socket.emit("property updated", {message: "Viscosity updated successfully"});
+        });
     });
 
     socket.on("frames per second changed", function(data) {
-        simulationManager.setSimulationFramesPerSecond(socket.id, data.value);
-        socket.emit("property updated", {message: "Frames per Second updated successfully"});
+        queue(function() {
+            simulationManager.setSimulationFramesPerSecond(socket.id, data.value);
+            socket.emit("property updated", {message: "Frames per Second updated successfully"});
+        });
+    });
+
+    //Thin clients limit the vertices of every frame, 0 sends every particle
+    socket.on("frame budget changed", function(data) {
+        queue(function() {
+            simulationManager.setSimulationFrameBudget(socket.id, data.value);
+            socket.emit("property updated", {message: "Frame Budget updated successfully"});
+        });
+    });
+
+    //Viewers that want to step back turn on the in memory checkpoints, 0 turns them off and frees them
+    socket.on("checkpoint interval changed", function(data) {
+        queue(function() {
+            simulationManager.setSimulationCheckpointInterval(socket.id, data.value);
+            socket.emit("property updated", {message: data.value > 0 ? "Recording checkpoints" : "Stopped recording checkpoints"});
+        });
+    });
+
+    //Colors the particles with a gradient of flat r,g,b components from dense to sparse particles
+    socket.on("color map changed", function(data) {
+        queue(function() {
+            simulationManager.setSimulationColorMap(socket.id, data.value);
+            socket.emit("property updated", {message: "Color Map updated successfully"});
+        });
     });
 
     //Disconnect
     socket.on("disconnect", function(data) {
-        simulationManager.removeSimulation(socket.id);
+        queue(function() {
+            simulationManager.removeSimulation(socket.id);
+        });
         connections.splice(connections.indexOf(socket), 1);
         console.log("disconnected: %s sockets connected", connections.length);
     });
 });
 
-// used to start a new simulation
+// used to start a new simulation stepping on its own thread, returns a Promise that resolves once it has been created
 function startSimulation(id, datafile, settingsfile) {
     if(datafile !== "" && settingsfile !== "") {
-        simulationManager.addSimulation(id, datafile, settingsfile);
+        return addSimulationAsync(id, datafile, settingsfile).then(function() {
+            return simulationManager.startSimulationScheduler(id);
+        });
     }
+    return Promise.resolve(false);
+}
+
+// used to wrap a simulation manager function taking a callback(err, result) into one returning a Promise
+function promisify(fn) {
+    return function() {
+        var args = Array.prototype.slice.call(arguments);
+        return new Promise(function(resolve, reject) {
+            args.push(function(err, result) {
+                if(err) {
+                    reject(err);
+                }
+                else {
+                    resolve(result);
+                }
+            });
+            fn.apply(null, args);
+        });
+    };
 }
\ No newline at end of file
@@ -34,6 +34,14 @@ namespace xlib {
 				_x[i] = xa._x[i];
 			}
 		}
+		xarray(xarray<T> &&xa) noexcept {
+			_x = xa._x;
+			_xsize = xa._xsize;
+			_ysize = xa._ysize;
+			xa._x = NULL;
+			xa._xsize = 0;
+			xa._ysize = 1;
+		}
 		xarray(unsigned int xsize) {
 			_x = new T[xsize];
 			_ysize = 1;
@@ -53,7 +61,8 @@ namespace xlib {
 		~xarray() {
 			delete[] _x;
 		}
-		inline xarray operator =(const xarray<T> &xa) {
+		inline xarray& operator =(const xarray<T> &xa) {
+			if (&xa == this) return *this;
 			delete[] _x;
 			_x = new T[xa._xsize*xa._ysize];
 			_xsize = xa._xsize;
@@ -63,7 +72,18 @@ namespace xlib {
 			}
 			return *this;
 		}
-		inline xarray operator =(const std::vector<T> &v) {
+		inline xarray& operator =(xarray<T> &&xa) {
+			if (&xa == this) return *this;
+			delete[] _x;
+			_x = xa._x;
+			_xsize = xa._xsize;
+			_ysize = xa._ysize;
+			xa._x = NULL;
+			xa._xsize = 0;
+			xa._ysize = 1;
+			return *this;
+		}
+		inline xarray& operator =(const std::vector<T> &v) {
 			clear();
 			resize(v.size());
 			for (unsigned int i = 0; i < v.size(); i++) {
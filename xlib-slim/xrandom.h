@@ -0,0 +1,56 @@
+#ifndef XRANDOM_H
+#define XRANDOM_H
+
+#include <stdint.h>
+
+namespace xlib {
+
+	class xrandom {
+		//xrandom (Counter based random numbers) class
+		//Philox4x32-10 generator from "Parallel Random Numbers: As Easy as 1, 2, 3" (Salmon et al. 2011)
+		//Every block of four values is a pure function of the seed and a three word counter,
+		//so values can be drawn in any order and from any thread and are always the same
+		//Typical counters are (item index, step, stream) so every item and step gets its own values
+
+	public:
+		xrandom(uint64_t seed = 0) {
+			_key[0] = (uint32_t)seed;
+			_key[1] = (uint32_t)(seed >> 32);
+		}
+
+		//Fills out with the four random words of the given counter
+		void block(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t out[4]) const {
+			uint32_t x0 = c0, x1 = c1, x2 = c2, x3 = 0;
+			uint32_t k0 = _key[0], k1 = _key[1];
+			for (int round = 0; round < 10; round++) {
+				uint64_t p0 = (uint64_t)0xD2511F53u * x0;
+				uint64_t p1 = (uint64_t)0xCD9E8D57u * x2;
+				uint32_t y0 = (uint32_t)(p1 >> 32) ^ x1 ^ k0;
+				uint32_t y1 = (uint32_t)p1;
+				uint32_t y2 = (uint32_t)(p0 >> 32) ^ x3 ^ k1;
+				uint32_t y3 = (uint32_t)p0;
+				x0 = y0; x1 = y1; x2 = y2; x3 = y3;
+				k0 += 0x9E3779B9u;
+				k1 += 0xBB67AE85u;
+			}
+			out[0] = x0;
+			out[1] = x1;
+			out[2] = x2;
+			out[3] = x3;
+		}
+
+		//Fills out with four floats in [0, 1) of the given counter
+		void block(uint32_t c0, uint32_t c1, uint32_t c2, float out[4]) const {
+			uint32_t words[4];
+			block(c0, c1, c2, words);
+			for (int i = 0; i < 4; i++) {
+				out[i] = (words[i] >> 8) * (1.0f / 16777216.0f);
+			}
+		}
+
+	private:
+		uint32_t _key[2];
+	};
+}
+
+#endif